@@ -409,6 +409,12 @@ SRC_FILES := $(wildcard $(SRC_DIR)/*.cpp)
 
 OBJ_FILES := $(SRC_FILES:$(SRC_DIR)/%.cpp=%.o)
 
+# standalone tests and benchmarks, linked only with the sources that don't use the engine or game SDKs
+# (built without a GAME_ define, so game.h adds nothing)
+TEST_DIR := tests
+TEST_SRC_FILES := $(addprefix $(SRC_DIR)/,banstore.cpp cmdindex.cpp ip.cpp str.cpp userstore.cpp)
+TEST_BINS := $(patsubst $(TEST_DIR)/%.cpp,$(BIN_DIR)/test/%,$(wildcard $(TEST_DIR)/test_*.cpp))
+
 CPPFLAGS := -MMD -MP -I ./include -isystem ../qmm_sdks -isystem ../qmm2/include
 CFLAGS   := -Wall -pipe -fPIC
 LDFLAGS  := -shared -fPIC
@@ -416,6 +422,7 @@ LDLIBS   :=
 
 REL_CPPFLAGS := $(CPPFLAGS)
 DBG_CPPFLAGS := $(CPPFLAGS) -D_DEBUG
+TEST_CPPFLAGS := -I ./include
 
 REL_CFLAGS_32 := $(CFLAGS) -m32 -O2 -ffast-math -falign-loops=2 -falign-jumps=2 -falign-functions=2 -fno-strict-aliasing -fstrength-reduce 
 REL_CFLAGS_64 := $(CFLAGS) -O2 -ffast-math -falign-loops=2 -falign-jumps=2 -falign-functions=2 -fno-strict-aliasing -fstrength-reduce 
@@ -427,7 +434,7 @@ REL_LDFLAGS_64 := $(LDFLAGS)
 DBG_LDFLAGS_32 := $(LDFLAGS) -m32 -g -pg
 DBG_LDFLAGS_64 := $(LDFLAGS) -g -pg
 
-.PHONY: help all clean release debug release32 debug32 release64 debug64 $(addprefix game-,$(GAMES)) $(addprefix release-,$(GAMES)) $(addprefix debug-,$(GAMES))
+.PHONY: help all clean test release debug release32 debug32 release64 debug64 $(addprefix game-,$(GAMES)) $(addprefix release-,$(GAMES)) $(addprefix debug-,$(GAMES))
 
 help:
 	@echo make targets:
@@ -445,6 +452,7 @@ help:
 	@echo release64-[GAME]: [64-bit release build for GAME]
 	@echo debug32-[GAME]: [32-bit debug build for GAME]
 	@echo debug64-[GAME]: [64-bit release build for GAME]
+	@echo test: [build and run tests and benchmarks]
 
 all: release debug
 release: release32 release64
@@ -502,6 +510,13 @@ $(OBJ_DIR)/debug-$(1)/x86_64/%.o: $(SRC_DIR)/%.cpp
 endef
 $(foreach game,$(GAMES),$(eval $(call gen_rules,$(game))))
 
+test: $(TEST_BINS)
+	@for t in $^; do ./$$t || exit 1; done
+
+$(BIN_DIR)/test/%: $(TEST_DIR)/%.cpp $(TEST_DIR)/test.h $(TEST_SRC_FILES)
+	mkdir -p $(@D)
+	$(CC) $(TEST_CPPFLAGS) $(REL_CFLAGS_64) -o $@ $(filter %.cpp,$^)
+
 clean:
 	@$(RM) -rv $(BIN_DIR) $(OBJ_DIR)
 """
@@ -0,0 +1,126 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#ifndef QADMIN_QMM_BANS_H
+#define QADMIN_QMM_BANS_H
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ip.h"
+
+// ban reason and expiration
+typedef struct {
+	std::string reason;
+	time_t expires;		// 0 = never
+} ban_info;
+
+// path-compressed binary trie of banned address ranges, longest matching range wins
+// nodes are stored in a vector and linked by index, removed nodes are reused
+// ban info is kept in a parallel vector so lookups only touch the small nodes
+struct ban_trie {
+	typedef struct {
+		ip_addr prefix;		// masked to len bits
+		int len;
+		int child[2];		// next node for bit [len] = 0/1, or -1
+		bool banned;		// false for nodes that only join two branches
+		time_t expires;		// copy of bans[i].expires
+	} node;
+
+	std::vector<node> nodes;
+	std::vector<ban_info> bans;	// bans[i] is for nodes[i]
+	std::vector<int> freelist;
+	int root = -1;
+	size_t count = 0;
+	size_t lencount[129] = {};	// number of bans with each prefix length
+
+	void add(const ip_addr& addr, int prefixlen, const ban_info& ban);
+	bool remove(const ip_addr& addr, int prefixlen);
+	// find the longest unexpired range containing addr
+	const ban_info* find(const ip_addr& addr, time_t now) const;
+	// call func(prefix, len, ban) for every range
+	template <typename F> void for_each(F func) const;
+	void clear();
+
+private:
+	int alloc(const ip_addr& prefix, int len);
+};
+
+
+template <typename F>
+void ban_trie::for_each(F func) const {
+	if (root < 0)
+		return;
+
+	std::vector<int> stack = { root };
+	while (!stack.empty()) {
+		int i = stack.back();
+		const node& n = nodes[i];
+		stack.pop_back();
+		if (n.banned)
+			func(n.prefix, n.len, bans[i]);
+		for (int child : n.child) {
+			if (child >= 0)
+				stack.push_back(child);
+		}
+	}
+}
+
+
+// blocked bloom filter of banned ranges and guids, checked before the trie/map
+// each key only touches one 64-byte block, so a "not banned" answer costs a cache line per prefix length in use
+struct ban_filter {
+	std::vector<uint64_t> words;	// 8 words per block
+	size_t capacity = 0;			// keys that fit before the false positive rate gets too high
+	size_t count = 0;
+	bool dirty = true;				// needs a rebuild before use (a ban was removed or capacity was exceeded)
+	std::vector<uint8_t> lens;		// ip prefix lengths in the filter
+
+	void reset(size_t expected);
+	void add(uint64_t hash);
+	bool test(uint64_t hash) const;
+};
+
+
+// all QAdmin bans
+typedef struct {
+	ban_trie ips;
+	std::unordered_map<std::string, ban_info> ids;	// keyed by case-folded guid
+	ban_filter filter;
+} ban_store;
+
+extern ban_store g_bans;
+
+// changes and lookups on any ban store, in banstore.cpp
+std::string ban_id_key(std::string_view guid);
+void ban_filter_build(ban_store& store);
+bool ban_store_add_ip(ban_store& store, std::string_view ip, const ban_info& ban);
+bool ban_store_add_id(ban_store& store, std::string_view guid, const ban_info& ban);
+bool ban_store_remove(ban_store& store, std::string_view ipid);
+bool ban_store_maybe(const ban_store& store, const ip_addr* addr, std::string_view guid);
+const ban_info* ban_store_find(const ban_store& store, const ip_addr* addr, std::string_view guid, time_t now);
+
+// the bans in g_bans, in bans.cpp
+
+void bans_load();
+bool bans_save();
+size_t bans_purge(time_t now);
+size_t bans_count();
+bool ban_add_ip(std::string_view ip, const ban_info& ban);
+bool ban_add_id(std::string_view guid, const ban_info& ban);
+bool ban_remove(std::string_view ipid);
+const ban_info* ban_check(const ip_addr* addr, std::string_view guid, time_t now);
+
+#endif // QADMIN_QMM_BANS_H
@@ -14,10 +14,30 @@ Created By:
 
 #include <vector>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <cstdint>
 
 #include "main.h"
+#include "util.h"
 
-typedef int (*pfnAdminCmd)(intptr_t clientnum, int access, std::vector<std::string> args, bool say);		// signature of a command handler
+typedef int (*pfnAdminCmd)(intptr_t clientnum, int access, cmd_args args, bool say);		// signature of a command handler
+typedef int (*pfnAdminCmdCompat)(intptr_t clientnum, int access, std::vector<std::string> args, bool say);		// old signature of a command handler
+
+// wraps a handler with the old signature so it can be placed in a command table
+// (copies the args into a vector for each call)
+template <pfnAdminCmdCompat func>
+int cmd_compat(intptr_t clientnum, int access, cmd_args args, bool say) {
+	return func(clientnum, access, std::vector<std::string>(args.begin(), args.end()), say);
+}
+
+// usage counters for a command, shown by "admin_stats cmds"
+typedef struct {
+	uint64_t calls;		// times the handler was run
+	uint64_t denied;	// times it was refused for lack of access
+	uint64_t total;		// ns spent in the handler
+	uint64_t max;		// ns, longest single call
+} cmd_stats;
 
 // command handler info
 typedef struct {
@@ -27,13 +47,27 @@ typedef struct {
 	int minargs;
 	const char* usage;
 	const char* help;
+	mutable cmd_stats stats;	// updated through the const pointers in the lookup index
 } cmd_info;
 
+// case-folded lookup index for a command table
+typedef struct {
+	std::string names;	// folded command names, keys in map point into this
+	std::unordered_map<std::string_view, const cmd_info*> map;
+} cmd_index;
+
 extern std::vector<cmd_info> g_admincmds;
 extern std::vector<cmd_info> g_saycmds;
 
-void reload();
-int handlecommand(intptr_t clientnum, std::vector<std::string> args);
-int admin_adduser(addusertype type, std::vector<std::string> args);
+void cmd_index_build(cmd_index& index, const std::vector<cmd_info>& cmds);
+const cmd_info* cmd_index_find(const cmd_index& index, std::string_view cmd);
+void reload(bool force = false);
+void reload_done();
+void reload_frame();
+void gag_build(const char* list);
+bool is_gagged_cmd(std::string_view cmd);
+bool cmd_prefilter(intptr_t clientnum);
+int handlecommand(intptr_t clientnum, cmd_args args);
+int admin_adduser(addusertype type, cmd_args args);
 
 #endif // QADMIN_QMM_UTIL_H
@@ -0,0 +1,46 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#ifndef QADMIN_QMM_CVARS_H
+#define QADMIN_QMM_CVARS_H
+
+#include <string>
+
+typedef void (*pfnCvarChanged)(const char* value);		// called when a cached cvar's value changes
+
+// QAdmin cvar with its value cached, refreshed once per frame by cvars_update()
+typedef struct {
+	const char* name;
+	const char* defvalue;
+	int flags;
+	pfnCvarChanged onchange;
+	std::string string;
+	int integer;
+} cached_cvar;
+
+extern cached_cvar g_admin_default_access;
+extern cached_cvar g_admin_vote_kick_time;
+extern cached_cvar g_admin_vote_map_time;
+extern cached_cvar g_admin_vote_custom_time;
+extern cached_cvar g_admin_config_file;
+extern cached_cvar g_admin_db_file;
+extern cached_cvar g_admin_auto_auth;
+extern cached_cvar g_admin_ban_file;
+extern cached_cvar g_admin_output_budget;
+extern cached_cvar g_admin_job_budget;
+extern cached_cvar g_admin_profile;
+extern cached_cvar g_admin_slow_cmd_time;
+extern cached_cvar g_admin_gagged_cmds;
+
+void cvars_register();
+void cvars_update();
+
+#endif // QADMIN_QMM_CVARS_H
@@ -63,6 +63,8 @@ Created By:
     #define GAME_CLIENT_ENT_PTRS
     #define GAME_NO_SEND_SERVER_COMMAND
     #define GAME_NO_FS_GETFILELIST
+    #define GAME_CONNECT_RETURNS_BOOL
+    #define GAME_SV_SERVER_COMMANDS
 #elif defined(GAME_Q2R)
     #include <q2r/rerelease/g_local.h>
     #include <game_q2r.h>
@@ -70,6 +72,8 @@ Created By:
     #define GAME_CLIENT_ENT_PTRS
     #define GAME_NO_SEND_SERVER_COMMAND
     #define GAME_NO_FS_GETFILELIST
+    #define GAME_CONNECT_RETURNS_BOOL
+    #define GAME_SV_SERVER_COMMANDS
 #elif defined(GAME_Q3A)
     #include <q3a/game/g_local.h>
 #elif defined(GAME_RTCWMP)
@@ -83,6 +87,8 @@ Created By:
     #define GAME_CLIENT_ENT_PTRS
     #define GAME_NO_SEND_SERVER_COMMAND
     #define GAME_NO_FS_GETFILELIST
+    #define GAME_CONNECT_RETURNS_BOOL
+    #define GAME_SV_SERVER_COMMANDS
 #elif defined(GAME_SOF2MP)
     #include <sof2mp/game/g_local.h>
 #elif defined(GAME_STEF2)
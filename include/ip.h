@@ -0,0 +1,45 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#ifndef QADMIN_QMM_IP_H
+#define QADMIN_QMM_IP_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+#define IP_V4_PREFIX 96		// prefix length of the ::ffff:0:0/96 range that IPv4 addresses are mapped into
+
+// binary IPv4 or IPv6 address
+// IPv4 addresses are stored as IPv4-mapped IPv6 addresses (::ffff:a.b.c.d) so both can be matched the same way
+struct ip_addr {
+	uint8_t bytes[16] = {};
+
+	bool operator==(const ip_addr& other) const;
+	bool operator!=(const ip_addr& other) const { return !(*this == other); }
+};
+
+struct ip_addr_hash {
+	size_t operator()(const ip_addr& addr) const;
+};
+
+bool ip_parse(std::string_view str, ip_addr& addr);
+bool ip_parse_cidr(std::string_view str, ip_addr& addr, int& prefixlen);
+bool ip_is_v4(const ip_addr& addr);
+void ip_mask(ip_addr& addr, int prefixlen);
+bool ip_match(const ip_addr& addr, const ip_addr& net, int prefixlen);
+int ip_bit(const ip_addr& addr, int n);
+int ip_common_bits(const ip_addr& a, const ip_addr& b, int max);
+std::string ip_to_str(const ip_addr& addr);
+std::string ip_cidr_to_str(const ip_addr& addr, int prefixlen);
+
+#endif // QADMIN_QMM_IP_H
@@ -0,0 +1,26 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#ifndef QADMIN_QMM_JOBS_H
+#define QADMIN_QMM_JOBS_H
+
+#include <cstddef>
+#include <functional>
+
+// one step of a background job, returns true when the job is finished
+// steps should be short, jobs_frame() only checks the budget between steps
+typedef std::function<bool()> job_step;
+
+void job_add(const char* name, job_step step);
+void jobs_frame();
+size_t jobs_count();
+
+#endif // QADMIN_QMM_JOBS_H
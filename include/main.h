@@ -15,8 +15,11 @@ Created By:
 #include <vector>
 #include <map>
 #include <string>
+#include <cstdint>
 
 #include "game.h"
+#include "ip.h"
+#include "timers.h"
 
 #ifdef MAX_STRING_LENGTH
 #undef MAX_STRING_LENGTH
@@ -28,6 +31,13 @@ Created By:
 
 #define SERVER_CONSOLE -2
 
+// number of client slots tracked
+#ifdef MAX_CLIENTS
+#define QADMIN_MAX_CLIENTS MAX_CLIENTS
+#else
+#define QADMIN_MAX_CLIENTS 256
+#endif
+
 typedef enum {
 	au_ip = 1,
 	au_name = 2,
@@ -62,27 +72,152 @@ typedef enum {
 
 typedef struct {
 	std::string guid;
+	std::string rawip;	// ip as given in userinfo
 	std::string ip;
+	ip_addr ipaddr;		// binary form of ip, if ipvalid
+	bool ipvalid;
 	std::string name;
 	std::string stripname;
 	int access;
 	bool authed;
 	bool gagged;
+	timer_handle gagtimer;	// ends a temporary gag, 0 if none
 } player_info;
 
+// index of lowest set bit (bits must be non-zero)
+inline int bit_lowest(uint32_t bits) {
+	int i = 0;
+	while (!(bits & 1)) {
+		bits >>= 1;
+		i++;
+	}
+	return i;
+}
+
+// number of set bits
+inline int bit_count(uint32_t bits) {
+	int count = 0;
+	while (bits) {
+		bits &= bits - 1;
+		count++;
+	}
+	return count;
+}
+
+// fixed-size bitset of client slots
+struct client_set {
+	static const int num_words = (QADMIN_MAX_CLIENTS + 31) / 32;
+	uint32_t words[num_words] = {};
+
+	static bool valid(intptr_t clientnum) { return clientnum >= 0 && clientnum < QADMIN_MAX_CLIENTS; }
+
+	bool test(intptr_t clientnum) const { return valid(clientnum) && (words[clientnum / 32] & (1u << (clientnum % 32))); }
+	void set(intptr_t clientnum) { if (valid(clientnum)) words[clientnum / 32] |= (1u << (clientnum % 32)); }
+	void reset(intptr_t clientnum) { if (valid(clientnum)) words[clientnum / 32] &= ~(1u << (clientnum % 32)); }
+	void clear() { for (auto& w : words) w = 0; }
+	bool empty() const { for (auto w : words) if (w) return false; return true; }
+	bool operator==(const client_set& other) const { for (int i = 0; i < num_words; i++) if (words[i] != other.words[i]) return false; return true; }
+
+	// first set slot at or after clientnum, or -1 if none
+	intptr_t next(intptr_t clientnum) const {
+		for (intptr_t w = clientnum / 32; w < num_words; w++) {
+			uint32_t bits = words[w];
+			// mask off slots before clientnum in its own word
+			if (w == clientnum / 32)
+				bits &= ~0u << (clientnum % 32);
+			if (bits)
+				return w * 32 + bit_lowest(bits);
+		}
+		return -1;
+	}
+
+	// iterate over set slots
+	struct iterator {
+		const client_set* set;
+		intptr_t clientnum;
+		intptr_t operator*() const { return clientnum; }
+		iterator& operator++() { clientnum = set->next(clientnum + 1); return *this; }
+		bool operator!=(const iterator& other) const { return clientnum != other.clientnum; }
+	};
+	iterator begin() const { return { this, next(0) }; }
+	iterator end() const { return { this, -1 }; }
+};
+
+// player info for every client slot, with a separate entry for the server console
+// indexing never inserts: slots not currently connected just hold default info
+struct player_table {
+	player_info slots[QADMIN_MAX_CLIENTS];
+	player_info console;
+	player_info invalid;	// returned for out-of-range client numbers
+	client_set connected;
+
+	// is the client connected (the console always is)
+	bool has(intptr_t clientnum) const { return clientnum == SERVER_CONSOLE || connected.test(clientnum); }
+
+	// info for a connected client or the console, nullptr otherwise
+	player_info* find(intptr_t clientnum) { return has(clientnum) ? &(*this)[clientnum] : nullptr; }
+
+	player_info& operator[](intptr_t clientnum) {
+		if (clientnum == SERVER_CONSOLE)
+			return console;
+		if (!client_set::valid(clientnum)) {
+			invalid = {};
+			return invalid;
+		}
+		return slots[clientnum];
+	}
+
+	// mark client connected with fresh info
+	player_info& add(intptr_t clientnum) {
+		player_info& info = (*this)[clientnum];
+		info = {};
+		connected.set(clientnum);
+		return info;
+	}
+
+	// mark client disconnected and reset its info
+	void remove(intptr_t clientnum) {
+		if (!client_set::valid(clientnum))
+			return;
+		slots[clientnum] = {};
+		connected.reset(clientnum);
+	}
+
+	// iterate over connected client numbers
+	client_set::iterator begin() const { return connected.begin(); }
+	client_set::iterator end() const { return connected.end(); }
+};
+
 typedef struct {
 	std::string user;
 	std::string pass;
 	int access;
 	addusertype type;
+	size_t order;	// position in config, earlier entries win when several match
 } user_info;
 
-extern std::map<intptr_t, player_info> g_playerinfo;
-extern std::vector<user_info> g_userinfo;
+extern player_table g_playerinfo;
+
+// internal counters, shown by admin_stats
+typedef struct {
+	uint64_t clientcmds;		// client commands seen
+	uint64_t fastrejects;		// client commands ignored by cmd_prefilter()
+	uint64_t userinfo_updates;	// connect/userinfo changes that changed ip, guid or name
+	uint64_t userinfo_skipped;	// connect/userinfo changes that changed none of them
+	uint64_t autoauths;			// clients authenticated by admin_auto_auth
+	uint64_t banrejects;		// connections rejected by a ban
+	uint64_t banchecks;			// connections checked for bans
+	uint64_t banfilter_passes;	// ban checks that passed the bloom filter and needed a real lookup
+	uint64_t banfilter_false;	// ...of those, ones that were not actually banned
+	uint64_t output_prints;		// player_clientprint() calls queued for a client
+	uint64_t output_cmds;		// print commands sent to flush the queues
+	uint64_t job_steps;			// background job steps run
+	uint64_t job_frames;		// frames that ran job steps
+	uint64_t job_overbudget;	// ...of those, ones that went over admin_job_budget
+} qadmin_counters;
+extern qadmin_counters g_counters;
 
 extern time_t g_mapstart;
 extern time_t g_leveltime;
 
-extern std::vector<std::string> g_gaggedCmds;
-
 #endif // QADMIN_QMM_MAIN_H
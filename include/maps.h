@@ -0,0 +1,31 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#ifndef QADMIN_QMM_MAPS_H
+#define QADMIN_QMM_MAPS_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// maps on the server, read once with G_FS_GETFILELIST by maps_refresh()
+typedef struct {
+	std::string names;						// all map names (without ".bsp"), null-separated
+	std::vector<std::string_view> maps;		// views into names, sorted case-insensitively
+	bool loaded;							// false if the game can't list files
+} map_catalog;
+
+extern map_catalog g_maps;
+
+void maps_refresh();
+bool is_valid_map(std::string_view map);
+
+#endif // QADMIN_QMM_MAPS_H
@@ -0,0 +1,64 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#ifndef QADMIN_QMM_PROFILE_H
+#define QADMIN_QMM_PROFILE_H
+
+#include <chrono>
+#include <cstdint>
+
+#define PROF_BUCKETS 40		// bucket n counts times of 2^n-2^(n+1) ns, the last also counts anything longer
+// cmd values at or above these (or negative) share one histogram per hook
+#define PROF_MAX_GAME_CMD 256		// vmMain hooks (GAME_* values)
+#define PROF_MAX_SYSCALL_CMD 1024	// syscall hooks (G_* values)
+
+// log2-scale histogram of call times
+typedef struct {
+	uint64_t buckets[PROF_BUCKETS];
+	uint64_t count;
+	uint64_t total;		// ns
+	uint64_t max;		// ns
+} prof_hist;
+
+// the exported hooks that are timed
+typedef enum {
+	PROF_VMMAIN,
+	PROF_VMMAIN_POST,
+	PROF_SYSCALL,
+	PROF_SYSCALL_POST,
+	PROF_HOOKS
+} prof_hookid;
+
+inline uint64_t prof_now() {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void prof_add(prof_hist& hist, uint64_t ns);
+uint64_t prof_percentile(const prof_hist& hist, int percent);
+void prof_record(prof_hookid hook, intptr_t cmd, uint64_t ns);
+bool prof_enabled();
+void prof_reset();
+void prof_print(intptr_t clientnum);
+
+// times a hook call from construction to destruction
+// the hook and cmd are only looked up at the end, since hooks can be re-entered (i.e. G_DROP_CLIENT calling GAME_CLIENT_DISCONNECT)
+struct prof_timer {
+	prof_hookid hook;
+	intptr_t cmd;
+	uint64_t start;
+
+	prof_timer(prof_hookid hook, intptr_t cmd) : hook(hook), cmd(cmd), start(prof_enabled() ? prof_now() : 0) {}
+	~prof_timer() { if (start) prof_record(hook, cmd, prof_now() - start); }
+	prof_timer(const prof_timer&) = delete;
+	prof_timer& operator=(const prof_timer&) = delete;
+};
+
+#endif // QADMIN_QMM_PROFILE_H
@@ -0,0 +1,92 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#ifndef QADMIN_QMM_STR_H
+#define QADMIN_QMM_STR_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdarg>
+
+#ifdef _MSC_VER
+#include <sal.h>
+#endif
+
+// compile-time printf format checking
+// STR_FORMAT_ATTR(fmt, args) goes after the declaration (1-based argument positions, "this" counts in members)
+// STR_FORMAT_PARAM goes before the format parameter
+#if defined(__GNUC__) || defined(__clang__)
+#define STR_FORMAT_ATTR(fmt, args) __attribute__((format(printf, fmt, args)))
+#define STR_FORMAT_PARAM
+#elif defined(_MSC_VER)
+#define STR_FORMAT_ATTR(fmt, args)
+#define STR_FORMAT_PARAM _Printf_format_string_
+#else
+#define STR_FORMAT_ATTR(fmt, args)
+#define STR_FORMAT_PARAM
+#endif
+
+// case-insensitive (ASCII) string functions
+// these work on views and do not allocate. an SSE2 version is used if the CPU supports it
+
+int str_stristr(std::string_view haystack, std::string_view needle);
+int str_stricmp(std::string_view s1, std::string_view s2);
+int str_striequal(std::string_view s1, std::string_view s2);
+std::string_view str_fold(std::string_view str, char* buf, size_t size);
+
+const char* str_kernel_name();
+bool str_use_kernel(const char* name);
+
+// split str into views at each sep
+// empty tokens between separators are kept, but a trailing empty token is not
+void str_split(std::string_view str, std::vector<std::string_view>& out, char sep = ' ');
+std::vector<std::string_view> str_split(std::string_view str, char sep = ' ');
+// replace out with the space-separated tokens of buf, each null-terminated in place
+void str_tokenize(std::string& buf, std::vector<std::string_view>& out);
+// join argc args with spaces into buf, then str_tokenize() it
+void str_tokenize_args(const std::string* argv, size_t argc, std::string& buf, std::vector<std::string_view>& out);
+// split str into space-separated words, where "double quotes" group words together
+std::vector<std::string> str_split_quoted(std::string_view str);
+
+// 32-bit FNV-1a, pass a previous result as hash to continue hashing
+uint32_t hash_fnv1a(const char* data, size_t size, uint32_t hash = 2166136261u);
+
+// printf into a buffer, returns false if the result was truncated to fit
+bool str_vprintf(char* buf, size_t size, const char* fmt, va_list args);
+bool str_printf(char* buf, size_t size, STR_FORMAT_PARAM const char* fmt, ...) STR_FORMAT_ATTR(3, 4);
+
+// fixed-size formatting buffer, meant to live on the stack
+template <size_t N>
+struct str_buf {
+	char buf[N];
+	bool truncated = false;		// last printf() didn't fit
+
+	str_buf() { buf[0] = '\0'; }
+	str_buf(const str_buf&) = delete;
+	str_buf& operator=(const str_buf&) = delete;
+
+	// returns false if the result was truncated
+	bool printf(STR_FORMAT_PARAM const char* fmt, ...) STR_FORMAT_ATTR(2, 3) {
+		va_list args;
+		va_start(args, fmt);
+		truncated = !str_vprintf(buf, N, fmt, args);
+		va_end(args);
+		return !truncated;
+	}
+
+	const char* c_str() const { return buf; }
+	std::string_view view() const { return buf; }
+};
+
+#endif // QADMIN_QMM_STR_H
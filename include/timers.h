@@ -0,0 +1,29 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#ifndef QADMIN_QMM_TIMERS_H
+#define QADMIN_QMM_TIMERS_H
+
+#include <cstddef>
+#include <cstdint>
+
+typedef void (*pfnTimerFunc)(intptr_t param);
+
+// identifies a scheduled timer for timer_cancel(), 0 is never a valid handle
+typedef uint64_t timer_handle;
+
+uint64_t timer_now();
+timer_handle timer_add(uint64_t delayms, pfnTimerFunc func, intptr_t param);
+bool timer_cancel(timer_handle handle);
+void timer_frame();
+size_t timer_count();
+
+#endif // QADMIN_QMM_TIMERS_H
@@ -0,0 +1,136 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#ifndef QADMIN_QMM_USERS_H
+#define QADMIN_QMM_USERS_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "main.h"
+
+// password for ip/id entries that can only be used by admin_auto_auth, not admin_login
+#define USER_AUTO_PASS "*"
+
+// binary user database file (admin_db_file), written by admin_savedb
+// layout: header, records sorted by type then user, then the string table
+// all values are little-endian, strings are not null-terminated
+#define USERDB_MAGIC "QADB"
+#define USERDB_VERSION 1
+
+typedef struct {
+	char magic[4];			// USERDB_MAGIC
+	uint32_t version;		// USERDB_VERSION
+	uint32_t count;			// number of records
+	uint32_t strsize;		// size of string table
+	uint32_t checksum;		// FNV-1a of everything after the header
+} userdb_header;
+
+typedef struct {
+	uint8_t type;			// addusertype
+	uint8_t userlen;
+	uint8_t passlen;
+	uint8_t pad;
+	int32_t access;
+	uint32_t user;			// offset in string table (normalized with user_key())
+	uint32_t pass;			// offset in string table
+	uint32_t order;			// position of the entry in the original config
+} userdb_record;
+
+// result of a user lookup, views into the store or database
+typedef struct {
+	std::string_view pass;
+	int access;
+	size_t order;
+} user_match;
+
+// loaded database file, queried in place
+struct user_db {
+	std::vector<char> buf;
+	const userdb_record* records = nullptr;
+	const char* strings = nullptr;
+	size_t count = 0;
+
+	// read and validate a database file, returns false (and leaves the db empty) if missing or invalid
+	bool load(const char* file);
+	// validate the file data in buf and query it in place, returns an error message if invalid
+	const char* parse();
+	bool find(addusertype type, std::string_view key, user_match& match) const;
+	void clear();
+};
+
+// user entries from the database file and admin_adduser_*, indexed by type and case-folded user
+// an admin_adduser_* entry for a user that is also in the database replaces the database record
+struct user_store {
+	user_db db;
+	std::unordered_map<std::string, user_info> index[3];	// index[type - 1]
+	size_t count = 0;
+	size_t overrides = 0;	// entries in index that replace a database record
+
+	// add an entry, returns false if an entry with the same type and user was already added
+	bool add(const user_info& info);
+	// find an entry by type and user, case-insensitive
+	bool find(addusertype type, std::string_view user, user_match& match) const;
+	// find an entry by type and key from user_key()
+	bool find_key(addusertype type, std::string_view key, user_match& match) const;
+	// call func(type, key, match) for every entry
+	template <typename F> void for_each(F func) const;
+	// write all entries in the database file format
+	size_t serialize(std::vector<char>& out) const;
+	// write all entries to a database file
+	bool save(const char* file) const;
+	void clear();
+	void swap(user_store& other);
+	size_t size() const { return db.count + count - overrides; }
+};
+
+
+template <typename F>
+void user_store::for_each(F func) const {
+	user_match match;
+	for (size_t i = 0; i < db.count; i++) {
+		const userdb_record& rec = db.records[i];
+		// replaced by an admin_adduser_* entry, which is listed below
+		if (overrides && index[rec.type - 1].count(std::string(db.strings + rec.user, rec.userlen)))
+			continue;
+		match.pass = std::string_view(db.strings + rec.pass, rec.passlen);
+		match.access = rec.access;
+		match.order = rec.order;
+		func((addusertype)rec.type, std::string_view(db.strings + rec.user, rec.userlen), match);
+	}
+	for (auto& map : index) {
+		for (auto& it : map) {
+			match.pass = it.second.pass;
+			match.access = it.second.access;
+			match.order = it.second.order;
+			func(it.second.type, std::string_view(it.first), match);
+		}
+	}
+}
+
+
+// differences between two user stores
+typedef struct {
+	size_t added;
+	size_t removed;
+	size_t changed;		// same type and user, but different password or access
+} user_diff;
+
+extern user_store g_users;
+
+std::string user_key(addusertype type, std::string_view user);
+bool player_auto_auth(intptr_t clientnum);
+user_diff users_diff(const user_store& from, const user_store& to);
+
+#endif // QADMIN_QMM_USERS_H
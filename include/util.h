@@ -14,24 +14,56 @@ Created By:
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <cstdint>
+#include "main.h"
+#include "str.h"
+
+// non-owning view of a command's arguments (command name is [0])
+// tokens come from parse_args(), so each one is also null-terminated
+struct cmd_args {
+	const std::string_view* args = nullptr;
+	size_t count = 0;
+
+	cmd_args() = default;
+	cmd_args(const std::string_view* args, size_t count) : args(args), count(count) {}
+	cmd_args(const std::vector<std::string_view>& vec) : args(vec.data()), count(vec.size()) {}
+
+	size_t size() const { return count; }
+	bool empty() const { return !count; }
+	const std::string_view* begin() const { return args; }
+	const std::string_view* end() const { return args + count; }
+	const std::string_view& operator[](size_t i) const { return args[i]; }
+
+	// argument i as a C string
+	const char* c_str(size_t i) const { return args[i].data(); }
+	// arguments with the first n removed
+	cmd_args sub(size_t n) const { return n < count ? cmd_args(args + n, count - n) : cmd_args(); }
+};
 
 bool player_has_access(intptr_t clientnum, int reqaccess);
 void player_clientprint(intptr_t clientnum, const char* msg, bool chat = false);
+void player_clientprintf(intptr_t clientnum, STR_FORMAT_PARAM const char* fmt, ...) STR_FORMAT_ATTR(2, 3);
+void player_chatprintf(intptr_t clientnum, STR_FORMAT_PARAM const char* fmt, ...) STR_FORMAT_ATTR(2, 3);
+void server_command(STR_FORMAT_PARAM const char* fmt, ...) STR_FORMAT_ATTR(1, 2);
+void player_flush_output();
+void player_flush_output(const client_set& recipients);
+void player_broadcast(const client_set& recipients, const char* msg, bool chat = false);
+client_set players_with_access(int reqaccess);
 void player_kick(intptr_t clientnum, std::string message);
 std::string strip_codes(std::string name);
-std::vector<intptr_t> players_with_name(std::string find);
-std::vector<intptr_t> players_with_ip(std::string find);
-bool is_valid_map(std::string map);
-std::string str_sanitize(std::string str);
-
-int str_stristr(std::string haystack, std::string needle);
-int str_stricmp(std::string s1, std::string s2);
-int str_striequal(std::string s1, std::string s2);
+std::vector<intptr_t> players_with_name(std::string_view find);
+std::vector<intptr_t> players_with_ip(std::string_view find);
+void player_set_ip(intptr_t clientnum, std::string_view ip);
+void player_disconnect(intptr_t clientnum);
+bool fs_read_file(const char* file, std::vector<char>& out);
+bool fs_write_file(const char* file, const char* data, size_t size);
+std::string str_sanitize(std::string_view str);
 
-std::vector<std::string> parse_str(std::string str, char sep = ' ');
-std::vector<std::string> parse_args(int start);
+void info_scan(std::string_view info, const char* const* keys, std::string_view* values, size_t count);
+const std::vector<std::string_view>& parse_args(int start);
+std::vector<std::string> parse_argv_after(std::string_view cmd);
 
-std::string str_join(std::vector<std::string> arr, size_t start = 0, char delim = ' ');
+std::string str_join(cmd_args arr, size_t start = 0, char delim = ' ');
 
 #endif // QADMIN_QMM_UTIL_H
@@ -13,25 +13,57 @@ Created By:
 #define QADMIN_QMM_VOTE_H
 
 #define MAX_CHOICES 9
+#define MAX_VOTES 4		// votes that can run at the same time
 
-#include <map>
+#include <string>
+#include <variant>
+#include <vector>
 #include <time.h>
+#include "main.h"
 
-typedef void (*pfnVoteFunc)(intptr_t winner, int winvotes, int totalvotes, void* param);
+// what a vote is about, owned by the vote
+typedef struct {
+	std::string map;
+} vote_map_param;
+
+typedef struct {
+	intptr_t clientnum;
+	std::string name;	// name at the start of the vote, in case the client leaves
+} vote_kick_param;
+
+typedef struct {
+	std::string question;
+	std::vector<std::string> options;
+} vote_custom_param;
+
+typedef std::variant<std::monostate, vote_map_param, vote_kick_param, vote_custom_param> vote_param;
+
+// winner is 0 if no one voted, ties go to the lowest choice
+typedef void (*pfnVoteFunc)(intptr_t winner, int winvotes, int totalvotes, const vote_param& param);
 
 typedef struct {
 	bool inuse;
+	int id;								// 1-MAX_VOTES, used with "castvote <id> <option>"
 	time_t finishtime;
 	pfnVoteFunc votefunc;
 	int choices;
-	void* param;
+	vote_param param;
+	std::string desc;					// shown when listing votes
 	intptr_t clientnum;
-	std::map<intptr_t, int> votes;	// votecount[clientnum] = choice
+	client_set voted;					// clients who have voted for any choice
+	client_set ballots[MAX_CHOICES];	// ballots[choice - 1] = clients who voted for choice
+	int counts[MAX_CHOICES];			// counts[choice - 1] = number of clients in ballots[choice - 1]
+	int total;							// number of clients in voted
+	timer_handle timer;					// finishes the vote when time is up
 } vote_info;
-extern vote_info g_vote;
+extern vote_info g_votes[MAX_VOTES];
 
-void vote_start(intptr_t clientnum, pfnVoteFunc callback, intptr_t seconds, int choices, void* param);
-void vote_add(intptr_t clientnum, int vote);
-void vote_finish();
+int vote_start(intptr_t clientnum, pfnVoteFunc callback, intptr_t seconds, int choices, vote_param param, std::string desc);
+void vote_add(intptr_t clientnum, int id, int vote);
+void vote_abort(intptr_t clientnum, int id);
+void vote_finish(vote_info& vote);
+void vote_remove_client(intptr_t clientnum);
+int vote_count();
+std::string vote_cmd(int id);
 
 #endif // QADMIN_QMM_VOTE_H
@@ -0,0 +1,353 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#define _CRT_SECURE_NO_WARNINGS 1
+
+#include <qmmapi.h>
+
+#include "version.h"
+#include "game.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include "main.h"
+#include "bans.h"
+#include "cvars.h"
+#include "ip.h"
+#include "jobs.h"
+#include "str.h"
+#include "timers.h"
+#include "util.h"
+
+ban_store g_bans;
+
+// purges bans when the next temporary ban runs out
+static timer_handle s_purgetimer = 0;
+static time_t s_purgetime = 0;
+
+#define BANS_LOAD_STEP 512	// ban file lines parsed per job step
+
+// ban file being loaded by a job, swapped into g_bans when done
+typedef struct {
+	std::vector<char> data;
+	std::vector<std::string_view> lines;	// point into data
+	size_t next;							// next line to parse
+	size_t bad;
+	time_t now;
+	ban_store store;
+	std::unordered_set<std::string> changed;	// keys of bans added or removed during the load, their lines are skipped
+	bool save;								// bans_save() was called during the load, save after the swap
+} ban_load_state;
+static std::shared_ptr<ban_load_state> s_load;
+static bool s_loaded = false;	// the ban file has been loaded since the plugin was loaded, later loads are only refreshes
+
+
+static void bans_schedule_purge(time_t expires);
+static void bans_schedule_all();
+
+
+// remove expired bans from memory and the ban file, then wait for the next one
+static void bans_purge_timer(intptr_t param) {
+	s_purgetimer = 0;
+	s_purgetime = 0;
+
+	time_t now = time(nullptr);
+	size_t removed = bans_purge(now);
+	if (removed) {
+		QMM_WRITEQMMLOG(QMMLOG_INFO, "Removed %zu expired bans\n", removed);
+		bans_save();
+	}
+
+	bans_schedule_all();
+}
+
+
+// make sure a purge runs when a ban expiring at the given time runs out
+static void bans_schedule_purge(time_t expires) {
+	if (!expires || (s_purgetimer && s_purgetime <= expires))
+		return;
+
+	time_t now = time(nullptr);
+	timer_cancel(s_purgetimer);
+	s_purgetime = expires;
+	s_purgetimer = timer_add(expires > now ? (uint64_t)(expires - now) * 1000 : 0, bans_purge_timer, 0);
+}
+
+
+// schedule a purge for every temporary ban
+static void bans_schedule_all() {
+	g_bans.ips.for_each([&](const ip_addr&, int, const ban_info& ban) {
+		bans_schedule_purge(ban.expires);
+	});
+	for (auto& it : g_bans.ids)
+		bans_schedule_purge(it.second.expires);
+}
+
+
+// keys for ban_load_state::changed
+static std::string ban_key_ip(const ip_addr& net, int prefixlen) {
+	return "ip " + ip_cidr_to_str(net, prefixlen);
+}
+
+
+static std::string ban_key_id(std::string_view guid) {
+	return "id " + ban_id_key(guid);
+}
+
+
+// key of an ip/range or guid, as given to ban_remove()
+static std::string ban_key(std::string_view ipid) {
+	ip_addr net;
+	int prefixlen;
+	if (ip_parse_cidr(ipid, net, prefixlen))
+		return ban_key_ip(net, prefixlen);
+	return ban_key_id(ipid);
+}
+
+
+// rebuild the filter after bans changed, so ban_check() never has to
+static void ban_filter_update() {
+	if (g_bans.filter.dirty)
+		ban_filter_build(g_bans);
+}
+
+
+// bans changed during a load are also made to the loading bans, and their keys are
+// remembered so the file's older lines for them are skipped
+bool ban_add_ip(std::string_view ip, const ban_info& ban) {
+	if (!ban_store_add_ip(g_bans, ip, ban))
+		return false;
+	if (s_load) {
+		ban_store_add_ip(s_load->store, ip, ban);
+		s_load->changed.insert(ban_key(ip));
+	}
+	ban_filter_update();
+	bans_schedule_purge(ban.expires);
+	return true;
+}
+
+
+bool ban_add_id(std::string_view guid, const ban_info& ban) {
+	if (!ban_store_add_id(g_bans, guid, ban))
+		return false;
+	if (s_load) {
+		ban_store_add_id(s_load->store, guid, ban);
+		s_load->changed.insert(ban_key_id(guid));
+	}
+	ban_filter_update();
+	bans_schedule_purge(ban.expires);
+	return true;
+}
+
+
+// remove an ip/range ban or a guid ban
+bool ban_remove(std::string_view ipid) {
+	bool removed = ban_store_remove(g_bans, ipid);
+	if (s_load) {
+		removed = ban_store_remove(s_load->store, ipid) || removed;
+		s_load->changed.insert(ban_key(ipid));
+	}
+	ban_filter_update();
+	return removed;
+}
+
+
+// check a connecting client's address (if it has one) and guid against the bans
+const ban_info* ban_check(const ip_addr* addr, std::string_view guid, time_t now) {
+	g_counters.banchecks++;
+
+	if (!ban_store_maybe(g_bans, addr, guid))
+		return nullptr;
+
+	g_counters.banfilter_passes++;
+	const ban_info* ban = ban_store_find(g_bans, addr, guid, now);
+	if (!ban)
+		g_counters.banfilter_false++;
+	return ban;
+}
+
+
+// remove expired bans, returns number removed
+size_t bans_purge(time_t now) {
+	std::vector<std::pair<ip_addr, int>> expired;
+	g_bans.ips.for_each([&](const ip_addr& prefix, int len, const ban_info& ban) {
+		if (ban.expires && ban.expires <= now)
+			expired.emplace_back(prefix, len);
+	});
+	for (auto& range : expired)
+		g_bans.ips.remove(range.first, range.second);
+
+	size_t removed = expired.size();
+	if (removed)
+		g_bans.filter.dirty = true;
+	for (auto it = g_bans.ids.begin(); it != g_bans.ids.end(); ) {
+		if (it->second.expires && it->second.expires <= now) {
+			it = g_bans.ids.erase(it);
+			removed++;
+			g_bans.filter.dirty = true;
+		}
+		else
+			++it;
+	}
+
+	ban_filter_update();
+	return removed;
+}
+
+
+size_t bans_count() {
+	return g_bans.ips.count + g_bans.ids.size();
+}
+
+
+// parse lines of the ban file into the loading bans, swap them in after the last line
+static bool bans_load_step(std::shared_ptr<ban_load_state> load) {
+	// a newer load replaced this one, and took over its changes (see bans_load_carry())
+	if (s_load != load)
+		return true;
+
+	size_t end = std::min(load->next + BANS_LOAD_STEP, load->lines.size());
+	for (; load->next < end; load->next++) {
+		std::string_view line = load->lines[load->next];
+		if (!line.empty() && line.back() == '\r')
+			line.remove_suffix(1);
+		if (line.empty() || line.substr(0, 2) == "//")
+			continue;
+
+		// type, ip/guid, expires, then the rest is the reason
+		std::string_view fields[3];
+		size_t i = 0;
+		for (; i < 3; i++) {
+			size_t sep = line.find(' ');
+			fields[i] = line.substr(0, sep);
+			line.remove_prefix(sep == std::string_view::npos ? line.size() : sep + 1);
+		}
+
+		ban_info ban = { std::string(line), (time_t)strtoll(std::string(fields[2]).c_str(), nullptr, 10) };
+		if (ban.expires && ban.expires <= load->now)
+			continue;
+
+		// already added or removed since the load started
+		if (!load->changed.empty() && load->changed.count(fields[0] == "id" ? ban_key_id(fields[1]) : ban_key(fields[1])))
+			continue;
+
+		bool ok = false;
+		if (fields[0] == "ip")
+			ok = ban_store_add_ip(load->store, fields[1], ban);
+		else if (fields[0] == "id")
+			ok = ban_store_add_id(load->store, fields[1], ban);
+		if (!ok)
+			load->bad++;
+	}
+	if (load->next < load->lines.size())
+		return false;
+
+	g_bans.ips = std::move(load->store.ips);
+	g_bans.ids = std::move(load->store.ids);
+	g_bans.filter.dirty = true;
+	ban_filter_update();
+	s_load.reset();
+	s_loaded = true;
+	bans_schedule_all();
+
+	if (load->bad)
+		QMM_WRITEQMMLOG(QMMLOG_WARNING, "Ignored %zu invalid lines in ban file \"%s\"\n", load->bad, g_admin_ban_file.string.c_str());
+	QMM_WRITEQMMLOG(QMMLOG_INFO, "Loaded %zu bans from \"%s\"\n", bans_count(), g_admin_ban_file.string.c_str());
+
+	if (load->save)
+		bans_save();
+	return true;
+}
+
+
+// when a load replaces one in progress, bans changed during the old load aren't in the file yet (bans_save() waits
+// for the load), so their keys and any pending save are carried over, and the ones still banned are copied from g_bans
+static void bans_load_carry(ban_load_state& load, const ban_load_state& old) {
+	load.changed = old.changed;
+	load.save = old.save;
+
+	bool ips = false;
+	for (auto& key : load.changed) {
+		if (key.compare(0, 3, "ip ") == 0) {
+			ips = true;
+			continue;
+		}
+		auto it = g_bans.ids.find(key.substr(3));
+		if (it != g_bans.ids.end())
+			ban_store_add_id(load.store, it->first, it->second);
+	}
+
+	// ranges can't be looked up exactly, so check them all
+	if (ips) {
+		g_bans.ips.for_each([&](const ip_addr& prefix, int len, const ban_info& ban) {
+			std::string key = ban_key_ip(prefix, len);
+			if (load.changed.count(key))
+				ban_store_add_ip(load.store, std::string_view(key).substr(3), ban);
+		});
+	}
+}
+
+
+// load bans from admin_ban_file, replacing the current bans
+// each line is "ip <ip[/prefix]> <expires> [reason]" or "id <guid> <expires> [reason]", expires is a unix time or 0
+// when bans were already loaded, the file is parsed by a background job and the current bans stay in use until it's done
+// otherwise (when the plugin was just loaded, i.e. at map start) it's parsed right away, so no one connects unchecked
+void bans_load() {
+	auto load = std::make_shared<ban_load_state>();
+	if (!fs_read_file(g_admin_ban_file.string.c_str(), load->data))
+		return;
+
+	load->next = 0;
+	load->bad = 0;
+	load->now = time(nullptr);
+	load->save = false;
+	str_split(std::string_view(load->data.data(), load->data.size()), load->lines, '\n');
+
+	if (s_load)
+		bans_load_carry(*load, *s_load);
+	s_load = load;
+	if (!s_loaded) {
+		while (!bans_load_step(load))
+			;
+		return;
+	}
+	job_add("load bans", [load]() { return bans_load_step(load); });
+}
+
+
+// write all bans to admin_ban_file
+bool bans_save() {
+	// the file is being loaded, write it once the load is done
+	if (s_load) {
+		s_load->save = true;
+		return true;
+	}
+
+	bans_purge(time(nullptr));
+
+	std::string out = "// QAdmin bans: ip <ip[/prefix]> <expires> [reason], id <guid> <expires> [reason]\n";
+	g_bans.ips.for_each([&](const ip_addr& prefix, int len, const ban_info& ban) {
+		out += "ip " + ip_cidr_to_str(prefix, len) + " " + std::to_string((long long)ban.expires) + " " + ban.reason + "\n";
+	});
+	for (auto& it : g_bans.ids)
+		out += "id " + it.first + " " + std::to_string((long long)it.second.expires) + " " + it.second.reason + "\n";
+
+	if (!fs_write_file(g_admin_ban_file.string.c_str(), out.data(), out.size())) {
+		QMM_WRITEQMMLOG(QMMLOG_WARNING, "Unable to write ban file \"%s\"\n", g_admin_ban_file.string.c_str());
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,375 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#define _CRT_SECURE_NO_WARNINGS 1
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "bans.h"
+#include "ip.h"
+#include "str.h"
+
+
+int ban_trie::alloc(const ip_addr& prefix, int len) {
+	int i;
+	if (!freelist.empty()) {
+		i = freelist.back();
+		freelist.pop_back();
+	}
+	else {
+		i = (int)nodes.size();
+		nodes.emplace_back();
+		bans.emplace_back();
+	}
+
+	node& n = nodes[i];
+	n.prefix = prefix;
+	ip_mask(n.prefix, len);
+	n.len = len;
+	n.child[0] = n.child[1] = -1;
+	n.banned = false;
+	n.expires = 0;
+	bans[i] = {};
+	return i;
+}
+
+
+void ban_trie::add(const ip_addr& addr, int prefixlen, const ban_info& ban) {
+	int parent = -1;	// node whose child[side] leads to cur, -1 for root
+	int side = 0;
+	int cur = root;
+	int target = -1;	// node to store the ban in
+
+	while (cur >= 0 && target < 0) {
+		int len = nodes[cur].len;
+		int common = ip_common_bits(nodes[cur].prefix, addr, std::min(len, prefixlen));
+
+		// the new range leaves this node's prefix early, so split it at the common bits
+		if (common < len) {
+			int mid = alloc(addr, common);
+			nodes[mid].child[ip_bit(nodes[cur].prefix, common)] = cur;
+			if (parent < 0)
+				root = mid;
+			else
+				nodes[parent].child[side] = mid;
+
+			if (common == prefixlen) {
+				target = mid;
+			}
+			else {
+				target = alloc(addr, prefixlen);
+				nodes[mid].child[ip_bit(addr, common)] = target;
+			}
+		}
+		// exact range already has a node
+		else if (len == prefixlen) {
+			target = cur;
+		}
+		else {
+			parent = cur;
+			side = ip_bit(addr, len);
+			cur = nodes[cur].child[side];
+		}
+	}
+
+	// fell off the end of a branch
+	if (target < 0) {
+		target = alloc(addr, prefixlen);
+		if (parent < 0)
+			root = target;
+		else
+			nodes[parent].child[side] = target;
+	}
+
+	if (!nodes[target].banned) {
+		count++;
+		lencount[prefixlen]++;
+	}
+	nodes[target].banned = true;
+	nodes[target].expires = ban.expires;
+	bans[target] = ban;
+}
+
+
+bool ban_trie::remove(const ip_addr& addr, int prefixlen) {
+	// path from the root, with the side taken out of each node
+	std::vector<std::pair<int, int>> path;
+	int cur = root;
+	while (cur >= 0) {
+		const node& n = nodes[cur];
+		if (n.len > prefixlen || ip_common_bits(n.prefix, addr, n.len) < n.len)
+			return false;
+		if (n.len == prefixlen)
+			break;
+		int side = ip_bit(addr, n.len);
+		path.emplace_back(cur, side);
+		cur = n.child[side];
+	}
+	if (cur < 0 || !nodes[cur].banned)
+		return false;
+
+	nodes[cur].banned = false;
+	bans[cur] = {};
+	count--;
+	lencount[prefixlen]--;
+
+	// remove nodes that no longer hold a ban or join two branches, working back up the path
+	path.emplace_back(cur, 0);
+	for (size_t i = path.size(); i-- > 0; ) {
+		int idx = path[i].first;
+		node& n = nodes[idx];
+		if (n.banned || (n.child[0] >= 0 && n.child[1] >= 0))
+			break;
+
+		int child = n.child[0] >= 0 ? n.child[0] : n.child[1];
+		if (i == 0)
+			root = child;
+		else
+			nodes[path[i - 1].first].child[path[i - 1].second] = child;
+		freelist.push_back(idx);
+
+		// node was replaced by its child, so the parent still has the same number of children
+		if (child >= 0)
+			break;
+	}
+
+	return true;
+}
+
+
+const ban_info* ban_trie::find(const ip_addr& addr, time_t now) const {
+	const ban_info* found = nullptr;
+	int cur = root;
+	while (cur >= 0) {
+		const node& n = nodes[cur];
+		if (!ip_match(addr, n.prefix, n.len))
+			break;
+		if (n.banned && (!n.expires || n.expires > now))
+			found = &bans[cur];
+		if (n.len >= 128)
+			break;
+		cur = n.child[ip_bit(addr, n.len)];
+	}
+	return found;
+}
+
+
+void ban_trie::clear() {
+	nodes.clear();
+	bans.clear();
+	freelist.clear();
+	root = -1;
+	count = 0;
+	for (auto& c : lencount)
+		c = 0;
+}
+
+
+static uint64_t hash_mix(uint64_t x) {
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdULL;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ULL;
+	x ^= x >> 33;
+	return x;
+}
+
+
+// filter key for a masked range
+static uint64_t ban_hash_ip(const ip_addr& net, int len) {
+	uint64_t hi, lo;
+	memcpy(&hi, net.bytes, sizeof(hi));
+	memcpy(&lo, net.bytes + 8, sizeof(lo));
+	return hash_mix(hi ^ hash_mix(lo ^ (uint64_t)len));
+}
+
+
+// filter key for a folded guid
+static uint64_t ban_hash_id(std::string_view key) {
+	uint64_t hash = 14695981039346656037ULL;
+	for (char c : key) {
+		hash ^= (uint8_t)c;
+		hash *= 1099511628211ULL;
+	}
+	return hash_mix(hash);
+}
+
+
+// size for about 10 bits per key (~1% false positives), in a power of two number of 512-bit blocks
+void ban_filter::reset(size_t expected) {
+	size_t blocks = 1;
+	while (blocks * 512 < expected * 10)
+		blocks *= 2;
+	words.assign(blocks * 8, 0);
+	capacity = blocks * 512 / 10;
+	count = 0;
+	dirty = false;
+	lens.clear();
+}
+
+
+// the low bits of the hash pick a block, then 7 bits in the block come from the top of a second hash
+void ban_filter::add(uint64_t hash) {
+	uint64_t* block = &words[(hash & (words.size() / 8 - 1)) * 8];
+	uint64_t bits = hash * 0x9e3779b97f4a7c15ULL;
+	for (int i = 0; i < 7; i++) {
+		unsigned bit = (unsigned)(bits >> (55 - i * 9)) & 511;
+		block[bit / 64] |= 1ULL << (bit % 64);
+	}
+	count++;
+}
+
+
+bool ban_filter::test(uint64_t hash) const {
+	const uint64_t* block = &words[(hash & (words.size() / 8 - 1)) * 8];
+	uint64_t bits = hash * 0x9e3779b97f4a7c15ULL;
+	for (int i = 0; i < 7; i++) {
+		unsigned bit = (unsigned)(bits >> (55 - i * 9)) & 511;
+		if (!(block[bit / 64] & (1ULL << (bit % 64))))
+			return false;
+	}
+	return true;
+}
+
+
+// rebuild the filter from all bans, with room to add more
+void ban_filter_build(ban_store& store) {
+	ban_filter& filter = store.filter;
+	filter.reset(std::max<size_t>(64, (store.ips.count + store.ids.size()) * 2));
+
+	store.ips.for_each([&](const ip_addr& prefix, int len, const ban_info&) {
+		filter.add(ban_hash_ip(prefix, len));
+	});
+	for (int len = 0; len <= 128; len++) {
+		if (store.ips.lencount[len])
+			filter.lens.push_back((uint8_t)len);
+	}
+	for (auto& it : store.ids)
+		filter.add(ban_hash_id(it.first));
+}
+
+
+// add a new ban to the filter, or mark it for a rebuild if it's full
+static void ban_filter_add(ban_filter& filter, uint64_t hash, int len = -1) {
+	if (filter.dirty)
+		return;
+	if (filter.count >= filter.capacity) {
+		filter.dirty = true;
+		return;
+	}
+
+	filter.add(hash);
+	if (len >= 0 && std::find(filter.lens.begin(), filter.lens.end(), (uint8_t)len) == filter.lens.end())
+		filter.lens.push_back((uint8_t)len);
+}
+
+
+// guids are case-insensitive
+std::string ban_id_key(std::string_view guid) {
+	std::string key(guid.size(), '\0');
+	str_fold(guid, key.data(), key.size());
+	return key;
+}
+
+
+// reason strings are stored on one line in the ban file
+static std::string ban_reason(std::string_view reason) {
+	std::string ret(reason);
+	for (auto& c : ret) {
+		if (c == '\n' || c == '\r')
+			c = ' ';
+	}
+	return ret;
+}
+
+
+bool ban_store_add_ip(ban_store& store, std::string_view ip, const ban_info& ban) {
+	ip_addr net;
+	int prefixlen;
+	if (!ip_parse_cidr(ip, net, prefixlen))
+		return false;
+
+	store.ips.add(net, prefixlen, { ban_reason(ban.reason), ban.expires });
+	ban_filter_add(store.filter, ban_hash_ip(net, prefixlen), prefixlen);
+	return true;
+}
+
+
+bool ban_store_add_id(ban_store& store, std::string_view guid, const ban_info& ban) {
+	if (guid.empty() || guid.find_first_of(" \t\r\n") != std::string_view::npos)
+		return false;
+
+	std::string key = ban_id_key(guid);
+	ban_filter_add(store.filter, ban_hash_id(key));
+	store.ids[std::move(key)] = { ban_reason(ban.reason), ban.expires };
+	return true;
+}
+
+
+bool ban_store_remove(ban_store& store, std::string_view ipid) {
+	// bits can't be removed from the filter
+	store.filter.dirty = true;
+
+	ip_addr net;
+	int prefixlen;
+	if (ip_parse_cidr(ipid, net, prefixlen))
+		return store.ips.remove(net, prefixlen);
+
+	return store.ids.erase(ban_id_key(ipid)) != 0;
+}
+
+
+// check the ban trie and guid map directly
+const ban_info* ban_store_find(const ban_store& store, const ip_addr* addr, std::string_view guid, time_t now) {
+	if (addr) {
+		const ban_info* ban = store.ips.find(*addr, now);
+		if (ban)
+			return ban;
+	}
+
+	if (!guid.empty() && !store.ids.empty()) {
+		auto it = store.ids.find(ban_id_key(guid));
+		if (it != store.ids.end() && (!it->second.expires || it->second.expires > now))
+			return &it->second;
+	}
+
+	return nullptr;
+}
+
+
+// check the filter for each prefix length in use, then the guid
+// returns false if the client is certainly not banned
+bool ban_store_maybe(const ban_store& store, const ip_addr* addr, std::string_view guid) {
+	// it's rebuilt whenever bans change, but if it somehow wasn't, just do the real lookup
+	const ban_filter& filter = store.filter;
+	if (filter.dirty)
+		return true;
+
+	if (addr) {
+		for (uint8_t len : filter.lens) {
+			ip_addr net = *addr;
+			ip_mask(net, len);
+			if (filter.test(ban_hash_ip(net, len)))
+				return true;
+		}
+	}
+	if (!guid.empty() && !store.ids.empty()) {
+		char buf[256];
+		std::string_view key = str_fold(guid, buf, sizeof(buf));
+		// too long to fold here, just check the map
+		return key.empty() || filter.test(ban_hash_id(key));
+	}
+	return false;
+}
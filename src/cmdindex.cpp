@@ -0,0 +1,54 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#define _CRT_SECURE_NO_WARNINGS 1
+
+#include <cctype>
+#include <cstring>	// strlen
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "main.h"
+#include "cmds.h"
+#include "str.h"
+
+
+// build a case-folded lookup index for a command table
+void cmd_index_build(cmd_index& index, const std::vector<cmd_info>& cmds) {
+	index.map.clear();
+	index.names.clear();
+
+	// reserve all the name storage up front so the views stay valid
+	size_t total = 0;
+	for (auto& cmd : cmds)
+		total += strlen(cmd.cmd);
+	index.names.reserve(total);
+	index.map.reserve(cmds.size());
+
+	for (auto& cmd : cmds) {
+		size_t start = index.names.size();
+		for (const char* c = cmd.cmd; *c; c++)
+			index.names += (char)std::tolower((unsigned char)*c);
+		index.map.emplace(std::string_view(index.names).substr(start), &cmd);
+	}
+}
+
+
+// find a command in the given index, case-insensitive
+const cmd_info* cmd_index_find(const cmd_index& index, std::string_view cmd) {
+	char buf[MAX_COMMAND_LENGTH];
+	std::string_view key = str_fold(cmd, buf, sizeof(buf));
+	if (key.empty())
+		return nullptr;
+
+	auto it = index.map.find(key);
+	return it != index.map.end() ? it->second : nullptr;
+}
@@ -16,89 +16,355 @@ Created By:
 #include "version.h"
 #include "game.h"
 
-#include <cstring>	// strlen
+#include <algorithm>
 #include <time.h>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <variant>
 #include "main.h"
+#include "ip.h"
 #include "cmds.h"
+#include "cvars.h"
+#include "bans.h"
+#include "jobs.h"
+#include "maps.h"
+#include "profile.h"
+#include "timers.h"
+#include "users.h"
 #include "vote.h"
 #include "util.h"
 
 
-void reload() {
-	// erase all user entries
-	g_userinfo.clear();
+static cmd_index s_admincmd_index;
+static cmd_index s_saycmd_index;
 
-	// re-exec the config file
-	g_syscall(G_SEND_CONSOLE_COMMAND, EXEC_APPEND, QMM_VARARGS("exec %s\n", QMM_GETSTRCVAR("admin_config_file")));
+// case-folded set of commands blocked for gagged players, built from admin_gagged_cmds
+static std::string s_gagcmds_cvar;	// cvar value the set was built from
+static std::string s_gagcmds_names;	// folded command names, keys in set point into this
+static std::unordered_set<std::string_view> s_gagcmds;
+
+
+// rebuild gagged command set from a comma-separated list
+// called by reload() and when admin_gagged_cmds changes
+void gag_build(const char* list) {
+	s_gagcmds_cvar = list;
+
+	s_gagcmds.clear();
+	s_gagcmds_names.resize(s_gagcmds_cvar.size());
+	std::string_view folded = str_fold(s_gagcmds_cvar, s_gagcmds_names.data(), s_gagcmds_names.size());
+
+	for (auto gagcmd : str_split(folded, ',')) {
+		// allow spaces around the commas
+		size_t start = gagcmd.find_first_not_of(' ');
+		if (start == std::string_view::npos)
+			continue;
+		gagcmd = gagcmd.substr(start, gagcmd.find_last_not_of(' ') + 1 - start);
+		s_gagcmds.insert(gagcmd);
+	}
+}
+
+
+// check if a command is in the gagged command set, case-insensitive
+bool is_gagged_cmd(std::string_view cmd) {
+	char buf[MAX_COMMAND_LENGTH];
+	std::string_view key = str_fold(cmd, buf, sizeof(buf));
+	if (key.empty())
+		return false;
+
+	return s_gagcmds.count(key) != 0;
+}
+
+
+// reload progress. the user database and config file are hashed first, and if neither changed
+// since g_users was built, there is nothing to reload
+// otherwise the config is exec'd, with a command after it to mark the end. the users are loaded into s_pending
+// while it runs, then swapped into g_users at the next frame so there is never a time with no users
+// games without filesystem access can't read the config, so it is exec'd on every reload and only its
+// admin_adduser_* lines are hashed. if they differ from the ones g_users was built from, the config is run
+// again to build the users. files exec'd by the config are not hashed, "admin_reload force" picks those up
+typedef enum {
+	rs_idle,
+	rs_checking,	// config exec'd, hashing and discarding user lines until admin_reload_done
+	rs_building,	// config exec'd, building s_pending until admin_reload_done
+	rs_ready,		// config finished, swap at next frame
+} reload_state;
+
+// frames to wait for admin_reload_done before giving up on it
+#define RELOAD_TIMEOUT_FRAMES 100
+
+static reload_state s_reload_state = rs_idle;
+static int s_reload_frames;			// frames since the config was exec'd
+static user_store s_pending;
+static uint32_t s_pending_hash;		// hash of the files (and user lines, without filesystem access) for this reload
+static bool s_pending_nocfg;		// config file could not be read
+static size_t s_pending_errors;		// bad admin_adduser_* lines while building
+static uint32_t s_config_hash;		// hash g_users was built from
+static bool s_config_hashed = false;
+
+
+// hash the user database and config file names and contents
+// returns false if the config file could not be read, which is always the case without filesystem access
+static bool reload_hash(uint32_t& hash) {
+	std::vector<char> data;
+	hash = hash_fnv1a(g_admin_db_file.string.c_str(), g_admin_db_file.string.size() + 1);
+	if (fs_read_file(g_admin_db_file.string.c_str(), data))
+		hash = hash_fnv1a(data.data(), data.size(), hash);
+
+	hash = hash_fnv1a(g_admin_config_file.string.c_str(), g_admin_config_file.string.size() + 1, hash);
+	if (!fs_read_file(g_admin_config_file.string.c_str(), data))
+		return false;
+	hash = hash_fnv1a(data.data(), data.size(), hash);
+	return true;
+}
+
+
+// exec the config file, either building new users or just checking if they changed
+static void reload_exec(reload_state state, uint32_t hash, bool nocfg) {
+	s_pending.clear();
+	s_pending_hash = hash;
+	s_pending_nocfg = nocfg;
+	s_pending_errors = 0;
+	s_reload_frames = 0;
+
+	// build new user entries off to the side, starting with the user database
+	if (state == rs_building && s_pending.db.load(g_admin_db_file.string.c_str()))
+		QMM_WRITEQMMLOG(QMMLOG_INFO, "Loaded %zu user entries from \"%s\"\n", s_pending.db.count, g_admin_db_file.string.c_str());
+	s_reload_state = state;
+
+	// re-exec the config file, followed by a command to mark the end of it
+	server_command("exec %s\n", g_admin_config_file.string.c_str());
+#ifdef GAME_SV_SERVER_COMMANDS
+	// idTech2 games only pass console commands to the mod with "sv" in front
+	g_syscall(G_SEND_CONSOLE_COMMAND, EXEC_APPEND, "sv admin_reload_done\n");
+#else
+	g_syscall(G_SEND_CONSOLE_COMMAND, EXEC_APPEND, "admin_reload_done\n");
+#endif
+}
+
+
+void reload(bool force) {
+	// make sure cached cvars are current (admin_config_file may have just been changed)
+	cvars_update();
+
+	// (re)build command lookup tables
+	cmd_index_build(s_admincmd_index, g_admincmds);
+	cmd_index_build(s_saycmd_index, g_saycmds);
 
 	// refresh gagged command list
-	g_gaggedCmds = parse_str(QMM_GETSTRCVAR("admin_gagged_cmds"), ',');
+	gag_build(g_admin_gagged_cmds.string.c_str());
+
+	// reload bans
+	bans_load();
+
+	// re-read the map list
+	maps_refresh();
+
+	// force starts over, in case the end of a previous reload was never seen
+	// otherwise, the config exec'd by the reload in progress will still apply any changes
+	if (s_reload_state != rs_idle && !force) {
+		QMM_WRITEQMMLOG(QMMLOG_INFO, "User reload already in progress\n");
+		return;
+	}
+
+	uint32_t hash;
+	bool hascfg = reload_hash(hash);
+
+	// without filesystem access, the config has to run to tell if the users changed
+	// (only rebuild right away if forced or there is nothing to compare against)
+	if (G_FS_FOPEN_FILE < 0)
+		reload_exec(force || !s_config_hashed ? rs_building : rs_checking, hash, false);
+	else if (!force && s_config_hashed && hash == s_config_hash)
+		QMM_WRITEQMMLOG(QMMLOG_INFO, "User config unchanged\n");
+	else
+		reload_exec(rs_building, hash, !hascfg);
 
 	QMM_WRITEQMMLOG(QMMLOG_INFO, "Configs/cvars (re)loaded\n");
 }
 
 
+// server command run after the config file exec'd by reload()
+void reload_done() {
+	if (s_reload_state == rs_building)
+		s_reload_state = rs_ready;
+	else if (s_reload_state == rs_checking) {
+		s_reload_state = rs_idle;
+		if (s_pending_hash == s_config_hash) {
+			QMM_WRITEQMMLOG(QMMLOG_INFO, "User config unchanged\n");
+			return;
+		}
+		// run the config again, keeping the users this time
+		QMM_WRITEQMMLOG(QMMLOG_INFO, "User config changed, reloading users\n");
+		uint32_t hash;
+		reload_hash(hash);
+		reload_exec(rs_building, hash, false);
+	}
+}
+
+
+// swap in the users built by reload(), called each frame
+void reload_frame() {
+	// if admin_reload_done never arrives, don't stay stuck in the middle of a reload
+	// users built so far are kept, anything run after this point adds to g_users directly
+	if ((s_reload_state == rs_checking || s_reload_state == rs_building) && ++s_reload_frames >= RELOAD_TIMEOUT_FRAMES) {
+		QMM_WRITEQMMLOG(QMMLOG_WARNING, "User reload did not finish after %d frames, ending it\n", RELOAD_TIMEOUT_FRAMES);
+		s_reload_state = s_reload_state == rs_building ? rs_ready : rs_idle;
+	}
+	if (s_reload_state != rs_ready)
+		return;
+	s_reload_state = rs_idle;
+
+	// if the config file is gone, don't wipe out the existing users
+	if (s_pending_nocfg && !s_pending.size() && g_users.size()) {
+		QMM_WRITEQMMLOG(QMMLOG_WARNING, "Unable to read \"%s\", keeping %zu existing user entries\n", g_admin_config_file.string.c_str(), g_users.size());
+		s_pending.clear();
+		return;
+	}
+
+	user_diff diff = users_diff(g_users, s_pending);
+	g_users.swap(s_pending);
+	s_pending.clear();
+	s_config_hash = s_pending_hash;
+	s_config_hashed = true;
+
+	QMM_WRITEQMMLOG(QMMLOG_INFO, "Users reloaded: %zu entries (%zu added, %zu removed, %zu changed, %zu invalid)\n", g_users.size(), diff.added, diff.removed, diff.changed, s_pending_errors);
+}
+
+
 // server command to add a new user
-int admin_adduser(addusertype type, std::vector<std::string> args) {
+int admin_adduser(addusertype type, cmd_args args) {
+	// without filesystem access, the lines are hashed during a reload to tell if the users changed
+	if (G_FS_FOPEN_FILE < 0 && (s_reload_state == rs_checking || s_reload_state == rs_building)) {
+		s_pending_hash = hash_fnv1a((const char*)&type, sizeof(type), s_pending_hash);
+		for (auto& arg : args) {
+			s_pending_hash = hash_fnv1a(arg.data(), arg.size(), s_pending_hash);
+			s_pending_hash = hash_fnv1a("", 1, s_pending_hash);
+		}
+	}
+	// only checking, the current users stay
+	if (s_reload_state == rs_checking)
+		QMM_RET_SUPERCEDE(1);
+
+	// during a reload, entries go into the new set of users
+	bool building = s_reload_state == rs_building;
+	user_store& users = building ? s_pending : g_users;
+
 	if (args.size() < 4) {
-		QMM_WRITEQMMLOG(QMMLOG_INFO, "Not enough parameters for %s <name|ip|id> <pass> <access>\n", args[0].c_str());
+		QMM_WRITEQMMLOG(QMMLOG_INFO, "Not enough parameters for %s <name|ip|id> <pass> <access>\n", args.c_str(0));
+		if (building)
+			s_pending_errors++;
 		QMM_RET_SUPERCEDE(1);
 	}
-	std::string user = args[1];
-	std::string pass = args[2];
-	int access = atoi(args[3].c_str());
+	std::string user(args[1]);
+	std::string pass(args[2]);
+	int access = atoi(args.c_str(3));
 
 	const char* strtype = (type == au_ip ? "IP" : (type == au_name ? "name" : "ID"));
 
-	for (auto& info : g_userinfo) {
-		if (info.type == type && str_striequal(user, info.user)) {
-			QMM_WRITEQMMLOG(QMMLOG_INFO, "User %s entry already exists for \"%s\"\n", strtype, user.c_str());
-			QMM_RET_SUPERCEDE(1);
-		}
+	user_info newuser = { user, pass, access, type };
+	if (!users.add(newuser)) {
+		QMM_WRITEQMMLOG(QMMLOG_INFO, "User %s entry already exists for \"%s\"\n", strtype, user.c_str());
+		if (building)
+			s_pending_errors++;
+		QMM_RET_SUPERCEDE(1);
 	}
 
-	user_info newuser = { user, pass, access, type };
-	g_userinfo.push_back(newuser);
+	// reloads report a summary when they finish instead
+	if (building)
+		QMM_RET_SUPERCEDE(1);
 
 	QMM_WRITEQMMLOG(QMMLOG_INFO, "New user %s entry added for \"%s\" (access=%d)\n", strtype, user.c_str(), access);
 	QMM_RET_SUPERCEDE(1);
 }
 
 
+// run a command's handler, keeping its stats and logging it if it took longer than admin_slow_cmd_time
+static int cmd_run(const cmd_info* cmd, intptr_t clientnum, cmd_args args, bool say) {
+	uint64_t start = prof_now();
+	int ret = (cmd->func)(clientnum, cmd->reqaccess, args, say);
+	uint64_t ns = prof_now() - start;
+
+	cmd_stats& stats = cmd->stats;
+	stats.calls++;
+	stats.total += ns;
+	if (ns > stats.max)
+		stats.max = ns;
+
+	if (g_admin_slow_cmd_time.integer > 0 && ns >= (uint64_t)g_admin_slow_cmd_time.integer * 1000) {
+		size_t argslen = 0;
+		for (auto& arg : args)
+			argslen += arg.size();
+		QMM_WRITEQMMLOG(QMMLOG_WARNING, "Slow command \"%s\"%s from client %d took %lluus (%zu args, %zu bytes)\n", cmd->cmd, say ? " (say)" : "",
+			(int)clientnum, (unsigned long long)(ns / 1000), args.size(), argslen);
+	}
+
+	return ret;
+}
+
+
+// quick check of a client command's argv[0] before tokenizing the whole command line
+// returns false if handlecommand() would ignore the command anyway
+bool cmd_prefilter(intptr_t clientnum) {
+	g_counters.clientcmds++;
+
+	char buf[MAX_COMMAND_LENGTH];
+	QMM_ARGV(0, buf, sizeof(buf));
+
+	// parse_args() splits on spaces, so handlecommand() will only see the first word
+	std::string_view cmd(buf);
+	cmd = cmd.substr(0, cmd.find(' '));
+
+	// registered command (including "say")
+	if (cmd_index_find(s_admincmd_index, cmd))
+		return true;
+
+	// gagged command from a gagged player
+	if (g_playerinfo[clientnum].gagged && is_gagged_cmd(cmd))
+		return true;
+
+	g_counters.fastrejects++;
+	return false;
+}
+
+
 // main command handler
 // clientnum = client that did the command
 // args = all args from engine (or say cmd)
-int handlecommand(intptr_t clientnum, std::vector<std::string> args) {
-	std::string cmd = args[0];
-
-	for (auto& admincmd : g_admincmds) {
-		if (str_striequal(admincmd.cmd, cmd)) {
-			// if the client has access, run handler func (get return value, func will set result flag)
-			if (player_has_access(clientnum, admincmd.reqaccess)) {
-				// only run handler func if we provided enough args
-				// otherwise, show the help entry
-				if (g_syscall(G_ARGC) < (admincmd.minargs + 1)) {
-					player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Missing parameters, usage:\n[QADMIN] %s\n", admincmd.usage));
-					QMM_RET_SUPERCEDE(1);
-				}
-				else
-					return (admincmd.func)(clientnum, admincmd.reqaccess, args, false);		// false = console command (not say)
-			}
-
-			// if client doesn't have access, give warning message
-			player_clientprint(clientnum, QMM_VARARGS("[QADMIN] You do not have access to that command: '%s'\n", cmd.c_str()));
+int handlecommand(intptr_t clientnum, cmd_args args) {
+	// nothing to handle (i.e. "admin_cmd" with no command)
+	if (args.empty()) {
+		if (clientnum == SERVER_CONSOLE)
 			QMM_RET_SUPERCEDE(1);
-		}
+		QMM_RET_IGNORED(0);
 	}
 
-	// check for gagged commands (but only for gagged users)
-	if (g_playerinfo[clientnum].gagged) {
-		for (auto gagcmd : g_gaggedCmds) {
-			if (str_striequal(cmd, gagcmd)) {
-				player_clientprint(clientnum, "[QADMIN] Sorry, you have been gagged.\n");
+	std::string_view cmd = args[0];
+
+	const cmd_info* admincmd = cmd_index_find(s_admincmd_index, cmd);
+	if (admincmd) {
+		// if the client has access, run handler func (get return value, func will set result flag)
+		if (player_has_access(clientnum, admincmd->reqaccess)) {
+			// only run handler func if we provided enough args
+			// otherwise, show the help entry
+			if (g_syscall(G_ARGC) < (admincmd->minargs + 1)) {
+				player_clientprintf(clientnum, "[QADMIN] Missing parameters, usage:\n[QADMIN] %s\n", admincmd->usage);
 				QMM_RET_SUPERCEDE(1);
 			}
+			else
+				return cmd_run(admincmd, clientnum, args, false);		// false = console command (not say)
 		}
+
+		// if client doesn't have access, give warning message
+		admincmd->stats.denied++;
+		player_clientprintf(clientnum, "[QADMIN] You do not have access to that command: '%s'\n", args.c_str(0));
+		QMM_RET_SUPERCEDE(1);
+	}
+
+	// check for gagged commands (but only for gagged users)
+	if (g_playerinfo[clientnum].gagged && is_gagged_cmd(cmd)) {
+		player_clientprint(clientnum, "[QADMIN] Sorry, you have been gagged.\n");
+		QMM_RET_SUPERCEDE(1);
 	}
 
 	if (clientnum == SERVER_CONSOLE)
@@ -111,15 +377,15 @@ int handlecommand(intptr_t clientnum, std::vector<std::string> args) {
 // clientnum = client that did the command
 // access = access required to run this command
 // args = all command args (include command in [0])
-int admin_help(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
+int admin_help(intptr_t clientnum, int access, cmd_args args, bool say) {
 	int start = 1;
 	if (args.size() > 1)
-		start = atoi(args[1].c_str());
+		start = atoi(args.c_str(1));
 
 	if (start <= 0 || start > (int)(g_admincmds.size() + g_saycmds.size()))
 		start = 1;
 	
-	player_clientprint(clientnum, QMM_VARARGS("[QADMIN] admin_help listing for %d-%d\n", start, start+9));
+	player_clientprintf(clientnum, "[QADMIN] admin_help listing for %d-%d\n", start, start+9);
 
 	// counter for valid commands
 	int count_cmd = 1;
@@ -131,7 +397,7 @@ int admin_help(intptr_t clientnum, int access, std::vector<std::string> args, bo
 		if (player_has_access(clientnum, cmd.reqaccess) && cmd.usage && cmd.usage[0] && cmd.help && cmd.help[0]) {
 			// if the command is within our display range
 			if (count_cmd >= start && count_cmd <= (start + 9)) {
-				player_clientprint(clientnum, QMM_VARARGS("[QADMIN] %d. %s - %s\n", count_show, cmd.usage, cmd.help));
+				player_clientprintf(clientnum, "[QADMIN] %d. %s - %s\n", count_show, cmd.usage, cmd.help);
 				++count_show;
 			}
 			++count_cmd;
@@ -142,7 +408,7 @@ int admin_help(intptr_t clientnum, int access, std::vector<std::string> args, bo
 }
 
 
-int admin_login(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
+int admin_login(intptr_t clientnum, int access, cmd_args args, bool say) {
 	if (clientnum == SERVER_CONSOLE) {
 		player_clientprint(clientnum, "[QADMIN] Trying to login from the server console, eh?\n");
 		QMM_RET_SUPERCEDE(1);
@@ -153,58 +419,69 @@ int admin_login(intptr_t clientnum, int access, std::vector<std::string> args, b
 		QMM_RET_SUPERCEDE(1);
 	}
 
-	std::string password = args[1];
-
-	for (auto& info : g_userinfo) {
-		std::string match = g_playerinfo[clientnum].name;
-		if (info.type == au_ip)
-			match = g_playerinfo[clientnum].ip;
-		else if (info.type == au_id)
-			match = g_playerinfo[clientnum].guid;
-
-		if (str_striequal(info.user, match) && str_striequal(info.pass, password)) {
-			g_playerinfo[clientnum].access = info.access;
-			g_playerinfo[clientnum].authed = true;
-			player_clientprint(clientnum, QMM_VARARGS("[QADMIN] You have successfully authenticated. You now have %d access.\n", g_playerinfo[clientnum].access));
-			QMM_RET_SUPERCEDE(1);
+	std::string_view password = args[1];
+	player_info& playerinfo = g_playerinfo[clientnum];
+
+	// at most one entry of each type can match, use the earliest one with the right password
+	const std::pair<addusertype, std::string_view> lookups[] = {
+		{ au_name, playerinfo.name },
+		{ au_ip, playerinfo.ip },
+		{ au_id, playerinfo.guid },
+	};
+	user_match login = {};
+	bool found = false;
+	for (auto& lookup : lookups) {
+		user_match match;
+		// auto-auth entries have no password to log in with
+		if (!g_users.find(lookup.first, lookup.second, match) || match.pass == USER_AUTO_PASS)
+			continue;
+		if (str_striequal(match.pass, password) && (!found || match.order < login.order)) {
+			login = match;
+			found = true;
 		}
 	}
 
+	if (found) {
+		playerinfo.access = login.access;
+		playerinfo.authed = true;
+		player_clientprintf(clientnum, "[QADMIN] You have successfully authenticated. You now have %d access.\n", playerinfo.access);
+	}
+
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_ban(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	std::string bancmd = args[0];
-	std::string user = args[1];
-
-	std::string message = str_join(args, 2);
-	if (message.empty())
-		message = "Banned by Admin";
+// ban a player by ip (and guid, if they have one), kicking everyone else on that ip without immunity
+// expires is 0 for a permanent ban
+static void ban_player(intptr_t clientnum, cmd_args args, time_t expires, std::string message) {
+	std::string_view user = args[1];
 
 	std::vector<intptr_t> targets = players_with_name(user);
 	if (targets.size() == 0) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Match not found for '%s'\n", user.c_str()));
-		QMM_RET_SUPERCEDE(1);
+		player_clientprintf(clientnum, "[QADMIN] Match not found for '%s'\n", args.c_str(1));
+		return;
 	}
 	else if (targets.size() > 1) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Ambiguous match for '%s'\n", user.c_str()));
-		QMM_RET_SUPERCEDE(1);
+		player_clientprintf(clientnum, "[QADMIN] Ambiguous match for '%s'\n", args.c_str(1));
+		return;
 	}
 
 	intptr_t targetclient = targets[0];
+	player_info& target = g_playerinfo[targetclient];
 
 	// check if the desired user has immunity
 	if (player_has_access(targetclient, ACCESS_IMMUNITY)) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Cannot ban %s, user has immunity.\n", g_playerinfo[targetclient].name.c_str()));
-		QMM_RET_SUPERCEDE(1);
+		player_clientprintf(clientnum, "[QADMIN] Cannot ban %s, user has immunity.\n", target.name.c_str());
+		return;
 	}
 
 	// flag. true if at least 1 matching ip user has immunity
 	bool immunity = false;
 		
 	// find users who have the given IP without immunity
-	std::vector<intptr_t> findusers = players_with_ip(g_playerinfo[targetclient].ip);
+	std::vector<intptr_t> findusers;
+	if (target.ipvalid)
+		findusers = players_with_ip(target.ip);
 	auto it = findusers.begin();
 	while (it != findusers.end()) {
 		if (player_has_access(*it, ACCESS_IMMUNITY)) {
@@ -215,33 +492,82 @@ int admin_ban(intptr_t clientnum, int access, std::vector<std::string> args, boo
 			++it;
 	}
 
+	ban_info ban = { message, expires };
+	std::string name = target.name;
+	std::string ip = target.ip;
+	bool banid = ban_add_id(target.guid, ban);
+
+	bool banip = !immunity && target.ipvalid && ban_add_ip(ip, ban);
+
 	// if no users with immunity have the IP, ban the IP and kick the user
-	if (!immunity) {
-		g_syscall(G_SEND_CONSOLE_COMMAND, EXEC_APPEND, QMM_VARARGS("addip \"%s\" \"%s\"\n", g_playerinfo[targetclient].ip.c_str(), message.c_str()));
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Banned %s by IP (%s): '%s'\n", g_playerinfo[targetclient].name.c_str(), g_playerinfo[targetclient].ip.c_str(), message.c_str()));
-		player_kick(targetclient, message);
+	if (banip) {
+		player_clientprintf(clientnum, "[QADMIN] Banned %s by IP (%s)%s: '%s'\n", name.c_str(), ip.c_str(), banid ? " and GUID" : "", message.c_str());
 	}
 	// else at least 1 user with immunity has the given IP
+	else if (target.ipvalid) {
+		player_clientprintf(clientnum, "[QADMIN] Cannot ban %s by IP, another user with that IP (%s) has immunity.%s\n", name.c_str(), ip.c_str(), banid ? " Banned by GUID." : "");
+	}
+	// bots and local clients have no address
 	else {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Cannot ban %s by IP, another user with that IP (%s) has immunity.\n", g_playerinfo[targetclient].name.c_str(), g_playerinfo[targetclient].ip.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Cannot ban %s by IP, user has no IP address.%s\n", name.c_str(), banid ? " Banned by GUID." : "");
 	}
 
-	// kick the users on the IP without immunity
-	for (auto& finduser : findusers)
+	if (banid || banip)
+		bans_save();
+
+	// kick the users on the IP without immunity (including the user)
+	bool kicked = false;
+	for (auto& finduser : findusers) {
 		player_kick(finduser, message);
+		kicked = kicked || finduser == targetclient;
+	}
+	if (!kicked && (banid || banip))
+		player_kick(targetclient, message);
+}
+
+
+int admin_ban(intptr_t clientnum, int access, cmd_args args, bool say) {
+	std::string message = str_join(args, 2);
+	if (message.empty())
+		message = "Banned by Admin";
+
+	ban_player(clientnum, args, 0, message);
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_banip(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	std::string bancmd = args[0];
-	std::string user = args[1];
+int admin_tempban(intptr_t clientnum, int access, cmd_args args, bool say) {
+	int minutes = atoi(args.c_str(2));
+	if (minutes <= 0) {
+		player_clientprint(clientnum, "[QADMIN] Ban time must be at least 1 minute\n");
+		QMM_RET_SUPERCEDE(1);
+	}
+
+	std::string message = str_join(args, 3);
+	if (message.empty())
+		message = "Banned by Admin for " + std::to_string(minutes) + " minutes";
+
+	ban_player(clientnum, args, g_leveltime + (time_t)minutes * 60, message);
+
+	QMM_RET_SUPERCEDE(1);
+}
+
+
+int admin_banip(intptr_t clientnum, int access, cmd_args args, bool say) {
+	std::string_view user = args[1];
 
 	std::string message = str_join(args, 2);
 	if (message.empty())
 		message = "Banned by Admin";
 
+	ip_addr net;
+	int prefixlen;
+	if (!ip_parse_cidr(user, net, prefixlen)) {
+		player_clientprintf(clientnum, "[QADMIN] Invalid IP address or range '%s'\n", args.c_str(1));
+		QMM_RET_SUPERCEDE(1);
+	}
+
 	// flag. true if at least 1 matching ip user has immunity
 	bool immunity = false;
 
@@ -259,12 +585,13 @@ int admin_banip(intptr_t clientnum, int access, std::vector<std::string> args, b
 
 	// if no users with immunity have the IP, ban the IP
 	if (!immunity) {
-		g_syscall(G_SEND_CONSOLE_COMMAND, EXEC_APPEND, QMM_VARARGS("addip \"%s\" \"%s\"\n", user.c_str(), message.c_str()));
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Banned IP %s: '%s'\n", user.c_str(), message.c_str()));
+		ban_add_ip(user, { message, 0 });
+		bans_save();
+		player_clientprintf(clientnum, "[QADMIN] Banned IP %s: '%s'\n", args.c_str(1), message.c_str());
 	}		
 	// else at least 1 user with immunity has the given IP
 	else {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Cannot ban IP %s, a user with that IP has immunity. Kicking non-immune users.\n", user.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Cannot ban IP %s, a user with that IP has immunity. Kicking non-immune users.\n", args.c_str(1));
 	}
 
 	// kick the users on the IP without immunity
@@ -275,86 +602,158 @@ int admin_banip(intptr_t clientnum, int access, std::vector<std::string> args, b
 }
 
 
-int admin_unban(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	std::string ip = str_sanitize(args[1]);
+int admin_banid(intptr_t clientnum, int access, cmd_args args, bool say) {
+	std::string_view guid = args[1];
+
+	std::string message = str_join(args, 2);
+	if (message.empty())
+		message = "Banned by Admin";
+
+	// don't ban an id that an immune player is using
+	std::vector<intptr_t> findusers;
+	for (intptr_t playernum : g_playerinfo) {
+		if (!str_striequal(g_playerinfo[playernum].guid, guid))
+			continue;
+		if (player_has_access(playernum, ACCESS_IMMUNITY)) {
+			player_clientprintf(clientnum, "[QADMIN] Cannot ban GUID %s, %s is using it and has immunity.\n", args.c_str(1), g_playerinfo[playernum].name.c_str());
+			QMM_RET_SUPERCEDE(1);
+		}
+		findusers.push_back(playernum);
+	}
+
+	if (!ban_add_id(guid, { message, 0 })) {
+		player_clientprintf(clientnum, "[QADMIN] Invalid GUID '%s'\n", args.c_str(1));
+		QMM_RET_SUPERCEDE(1);
+	}
+	bans_save();
+	player_clientprintf(clientnum, "[QADMIN] Banned GUID %s: '%s'\n", args.c_str(1), message.c_str());
 
-	g_syscall(G_SEND_CONSOLE_COMMAND, EXEC_APPEND, QMM_VARARGS("removeip \"%s\"\n", ip.c_str()));
-	player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Unbanned IP %s\n", ip.c_str()));
+	for (auto& finduser : findusers)
+		player_kick(finduser, message);
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_cfg(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
+int admin_unban(intptr_t clientnum, int access, cmd_args args, bool say) {
+	if (!ban_remove(args[1])) {
+		player_clientprintf(clientnum, "[QADMIN] No ban found for %s\n", args.c_str(1));
+		QMM_RET_SUPERCEDE(1);
+	}
+
+	bans_save();
+	player_clientprintf(clientnum, "[QADMIN] Unbanned %s\n", args.c_str(1));
+
+	QMM_RET_SUPERCEDE(1);
+}
+
+
+int admin_listbans(intptr_t clientnum, int access, cmd_args args, bool say) {
+	const size_t maxlist = 50;
+	size_t start = 1;
+	if (args.size() > 1)
+		start = (size_t)atoi(args.c_str(1));
+	if (!start)
+		start = 1;
+	size_t index = 0;
+
+	auto list = [&](const std::string& ipid, const ban_info& ban) {
+		if (ban.expires && ban.expires <= g_leveltime)
+			return;
+		index++;
+		if (index >= start && index < start + maxlist) {
+			if (ban.expires)
+				player_clientprintf(clientnum, "[QADMIN] %s (%d minutes left): %s\n", ipid.c_str(), (int)((ban.expires - g_leveltime + 59) / 60), ban.reason.c_str());
+			else
+				player_clientprintf(clientnum, "[QADMIN] %s: %s\n", ipid.c_str(), ban.reason.c_str());
+		}
+	};
+
+	player_clientprint(clientnum, "[QADMIN] Listing bans...\n");
+	g_bans.ips.for_each([&](const ip_addr& prefix, int len, const ban_info& ban) {
+		list(ip_cidr_to_str(prefix, len), ban);
+	});
+	for (auto& it : g_bans.ids)
+		list("GUID " + it.first, it.second);
+
+	if (index >= start + maxlist)
+		player_clientprintf(clientnum, "[QADMIN] %zu more, use 'admin_listbans %zu' to see more\n", index + 1 - start - maxlist, start + maxlist);
+	player_clientprint(clientnum, "[QADMIN] End of bans list\n");
+
+	QMM_RET_SUPERCEDE(1);
+}
+
+
+int admin_cfg(intptr_t clientnum, int access, cmd_args args, bool say) {
 	std::string file = str_sanitize(args[1]);
 
-	g_syscall(G_SEND_CONSOLE_COMMAND, EXEC_APPEND, QMM_VARARGS("exec \"%s\"\n", file.c_str()));
+	server_command("exec \"%s\"\n", file.c_str());
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_rcon(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
+int admin_rcon(intptr_t clientnum, int access, cmd_args args, bool say) {
 	std::string str = str_join(args, 1);
-	g_syscall(G_SEND_CONSOLE_COMMAND, EXEC_APPEND, QMM_VARARGS("%s\n", str.c_str()));
+	server_command("%s\n", str.c_str());
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_hostname(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	g_syscall(G_CVAR_SET, "sv_hostname", args[1].c_str());
+int admin_hostname(intptr_t clientnum, int access, cmd_args args, bool say) {
+	g_syscall(G_CVAR_SET, "sv_hostname", args.c_str(1));
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_friendlyfire(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	g_syscall(G_CVAR_SET, "g_friendlyfire", args[1].c_str());
+int admin_friendlyfire(intptr_t clientnum, int access, cmd_args args, bool say) {
+	g_syscall(G_CVAR_SET, "g_friendlyfire", args.c_str(1));
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_gravity(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	g_syscall(G_CVAR_SET, "g_gravity", args[1].c_str());
+int admin_gravity(intptr_t clientnum, int access, cmd_args args, bool say) {
+	g_syscall(G_CVAR_SET, "g_gravity", args.c_str(1));
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_gametype(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	g_syscall(G_CVAR_SET, "g_gametype", args[1].c_str());
+int admin_gametype(intptr_t clientnum, int access, cmd_args args, bool say) {
+	g_syscall(G_CVAR_SET, "g_gametype", args.c_str(1));
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_map(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
+int admin_map(intptr_t clientnum, int access, cmd_args args, bool say) {
 	std::string map = str_sanitize(args[1]);
-	g_syscall(G_SEND_CONSOLE_COMMAND, EXEC_APPEND, QMM_VARARGS("map \"%s\"\n", args[1].c_str()));
+	server_command("map \"%s\"\n", map.c_str());
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_fraglimit(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	g_syscall(G_CVAR_SET, "fraglimit", args[1].c_str());
+int admin_fraglimit(intptr_t clientnum, int access, cmd_args args, bool say) {
+	g_syscall(G_CVAR_SET, "fraglimit", args.c_str(1));
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_timelimit(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	g_syscall(G_CVAR_SET, "timelimit", args[1].c_str());
+int admin_timelimit(intptr_t clientnum, int access, cmd_args args, bool say) {
+	g_syscall(G_CVAR_SET, "timelimit", args.c_str(1));
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_pass(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
+int admin_pass(intptr_t clientnum, int access, cmd_args args, bool say) {
 	if (str_striequal(args[0], "admin_pass")) {
-		g_syscall(G_CVAR_SET, "g_password", args[1].c_str());
+		g_syscall(G_CVAR_SET, "g_password", args.c_str(1));
 		g_syscall(G_CVAR_SET, "g_needpass", "1");
 	} else if (str_striequal(args[0], "admin_nopass")) {
 		g_syscall(G_CVAR_SET, "g_password", "");
@@ -365,30 +764,32 @@ int admin_pass(intptr_t clientnum, int access, std::vector<std::string> args, bo
 }
 
 
-int admin_chat(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
+int admin_chat(intptr_t clientnum, int access, cmd_args args, bool say) {
 	std::string message = str_sanitize(str_join(args, 1));
-	for (auto& playerinfo : g_playerinfo) {
-		if (player_has_access(playerinfo.first, access))
-			player_clientprint(playerinfo.first, QMM_VARARGS("To Admins From %s: %s", clientnum == SERVER_CONSOLE ? "Console" : playerinfo.second.name.c_str(), message.c_str()), true);
-	}
+	str_buf<MAX_STRING_LENGTH> msg;
+	msg.printf("To Admins From %s: %s", clientnum == SERVER_CONSOLE ? "Console" : g_playerinfo[clientnum].name.c_str(), message.c_str());
+	player_broadcast(players_with_access(access), msg.c_str(), true);
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_csay(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
+int admin_csay(intptr_t clientnum, int access, cmd_args args, bool say) {
 	std::string message = str_sanitize(str_join(args, 1));
 #ifdef GAME_NO_SEND_SERVER_COMMAND
 	player_clientprint(-1, message.c_str(), false);
 #else
-	g_syscall(G_SEND_SERVER_COMMAND, -1, QMM_VARARGS("cp \"%s\n\"", message.c_str()));
+	str_buf<MAX_STRING_LENGTH> cmd;
+	cmd.printf("cp \"%s\n\"", message.c_str());
+	player_flush_output(g_playerinfo.connected);
+	g_syscall(G_SEND_SERVER_COMMAND, -1, cmd.c_str());
 #endif
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_say(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
+int admin_say(intptr_t clientnum, int access, cmd_args args, bool say) {
 	std::string message = str_sanitize(str_join(args, 1));
 	player_clientprint(-1, message.c_str(), true);
 
@@ -396,16 +797,16 @@ int admin_say(intptr_t clientnum, int access, std::vector<std::string> args, boo
 }
 
 
-int admin_psay(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	std::string user = args[1];
+int admin_psay(intptr_t clientnum, int access, cmd_args args, bool say) {
+	std::string_view user = args[1];
 
 	std::vector<intptr_t> targets = players_with_name(user);
 	if (targets.size() == 0) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Match not found for '%s'\n", user.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Match not found for '%s'\n", args.c_str(1));
 		QMM_RET_SUPERCEDE(1);
 	}
 	else if (targets.size() > 1) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Ambiguous match for '%s'\n", user.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Ambiguous match for '%s'\n", args.c_str(1));
 		QMM_RET_SUPERCEDE(1);
 	}
 
@@ -414,52 +815,53 @@ int admin_psay(intptr_t clientnum, int access, std::vector<std::string> args, bo
 	std::string message = str_sanitize(str_join(args, 2));	
 	std::string toname = g_playerinfo[targetclient].name;
 
-	player_clientprint(clientnum, QMM_VARARGS("Private Message To %s: %s", toname.c_str(), message.c_str()), true);
-	player_clientprint(targetclient, QMM_VARARGS("Private Message From %s: %s", clientnum == SERVER_CONSOLE ? "Console" : toname.c_str(), message.c_str()), true);
+	player_chatprintf(clientnum, "Private Message To %s: %s", toname.c_str(), message.c_str());
+	player_chatprintf(targetclient, "Private Message From %s: %s", clientnum == SERVER_CONSOLE ? "Console" : toname.c_str(), message.c_str());
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
 #ifndef GAME_NO_FS_GETFILELIST
-int admin_listmaps(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	char dirlist[MAX_STRING_LENGTH];
-
-	int numfiles = (int)g_syscall(G_FS_GETFILELIST, "maps", ".bsp", dirlist, sizeof(dirlist));
-	dirlist[sizeof(dirlist) - 1] = '\0';
-	char* dirptr = dirlist;
+int admin_listmaps(intptr_t clientnum, int access, cmd_args args, bool say) {
+	const size_t maxlist = 50;
+	size_t start = 1;
+	if (args.size() > 1)
+		start = (size_t)atoi(args.c_str(1));
+	if (!start || start > g_maps.maps.size())
+		start = 1;
+	size_t end = std::min(start + maxlist - 1, g_maps.maps.size());
 
-	player_clientprint(clientnum, "[QADMIN] Listing maps...\n");
-	for (int i = 1; i < numfiles; ++i) {
-		dirptr += strlen(dirptr);
-		*dirptr = '\n';
-	}
-	player_clientprint(clientnum, dirlist);
-	player_clientprint(clientnum, "\n[QADMIN] End of maps list\n");
+	player_clientprintf(clientnum, "[QADMIN] Listing maps %zu-%zu of %zu...\n", start, end, g_maps.maps.size());
+	for (size_t i = start; i <= end; i++)
+		player_clientprintf(clientnum, "%.*s\n", (int)g_maps.maps[i - 1].size(), g_maps.maps[i - 1].data());
+	if (end < g_maps.maps.size())
+		player_clientprintf(clientnum, "[QADMIN] Use 'admin_listmaps %zu' to see more\n", end + 1);
+	else
+		player_clientprint(clientnum, "[QADMIN] End of maps list\n");
 
 	QMM_RET_SUPERCEDE(1);
 }
 #endif
 
 
-int admin_kick(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	std::string kickcmd = args[0];
-	std::string user = args[1];
+int admin_kick(intptr_t clientnum, int access, cmd_args args, bool say) {
+	std::string_view user = args[1];
 
 	std::vector<intptr_t> targets = players_with_name(user);
 	if (targets.size() == 0) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Match not found for '%s'\n", user.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Match not found for '%s'\n", args.c_str(1));
 		QMM_RET_SUPERCEDE(1);
 	}
 	else if (targets.size() > 1) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Ambiguous match for '%s'\n", user.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Ambiguous match for '%s'\n", args.c_str(1));
 		QMM_RET_SUPERCEDE(1);
 	}
 
 	intptr_t targetclient = targets[0];
 
 	if (player_has_access(targetclient, ACCESS_IMMUNITY)) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Cannot kick %s, user has immunity\n", g_playerinfo[targetclient].name.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Cannot kick %s, user has immunity\n", g_playerinfo[targetclient].name.c_str());
 		QMM_RET_SUPERCEDE(1);
 	}
 	
@@ -467,29 +869,102 @@ int admin_kick(intptr_t clientnum, int access, std::vector<std::string> args, bo
 	if (message.empty())
 		message = "Kicked by Admin";
 	
-	player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Kicked %s: '%s'\n", g_playerinfo[targetclient].name.c_str(), message.c_str()));
+	player_clientprintf(clientnum, "[QADMIN] Kicked %s: '%s'\n", g_playerinfo[targetclient].name.c_str(), message.c_str());
 	player_kick(targetclient, message);
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_reload(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	reload();
+int admin_reload(intptr_t clientnum, int access, cmd_args args, bool say) {
+	reload(args.size() > 1 && str_striequal(args[1], "force"));
+
+	QMM_RET_SUPERCEDE(1);
+}
+
+
+int admin_savedb(intptr_t clientnum, int access, cmd_args args, bool say) {
+	std::string file = args.size() > 1 ? std::string(args[1]) : g_admin_db_file.string;
+	if (file.empty()) {
+		player_clientprint(clientnum, "[QADMIN] No database file given and admin_db_file is not set\n");
+		QMM_RET_SUPERCEDE(1);
+	}
+
+	if (!g_users.save(file.c_str())) {
+		player_clientprintf(clientnum, "[QADMIN] Unable to write user database to \"%s\"\n", file.c_str());
+		QMM_RET_SUPERCEDE(1);
+	}
+
+	player_clientprintf(clientnum, "[QADMIN] Wrote %zu user entries to \"%s\"\n", g_users.size(), file.c_str());
+	QMM_WRITEQMMLOG(QMMLOG_INFO, "Wrote %zu user entries to \"%s\"\n", g_users.size(), file.c_str());
+
+	QMM_RET_SUPERCEDE(1);
+}
+
+
+// list the commands in a table that have been used
+static void cmd_stats_print(intptr_t clientnum, const std::vector<cmd_info>& cmds, const char* prefix) {
+	for (auto& cmd : cmds) {
+		const cmd_stats& stats = cmd.stats;
+		if (!stats.calls && !stats.denied)
+			continue;
+		player_clientprintf(clientnum, "[QADMIN] %s%s: %llu calls, %llu denied, avg %lluus, max %lluus\n", prefix, cmd.cmd, (unsigned long long)stats.calls, (unsigned long long)stats.denied,
+			(unsigned long long)(stats.calls ? stats.total / stats.calls / 1000 : 0), (unsigned long long)(stats.max / 1000));
+	}
+}
+
+
+int admin_stats(intptr_t clientnum, int access, cmd_args args, bool say) {
+	if (args.size() > 1) {
+		if (str_striequal(args[1], "hooks")) {
+			player_clientprint(clientnum, "[QADMIN] QAdmin hook times:\n");
+			prof_print(clientnum);
+		}
+		else if (str_striequal(args[1], "cmds")) {
+			player_clientprint(clientnum, "[QADMIN] QAdmin command stats:\n");
+			cmd_stats_print(clientnum, g_admincmds, "");
+			cmd_stats_print(clientnum, g_saycmds, "say ");
+		}
+		else if (str_striequal(args[1], "reset")) {
+			prof_reset();
+			for (auto& cmd : g_admincmds)
+				cmd.stats = {};
+			for (auto& cmd : g_saycmds)
+				cmd.stats = {};
+			player_clientprint(clientnum, "[QADMIN] QAdmin hook times and command stats have been reset\n");
+		}
+		else
+			player_clientprintf(clientnum, "[QADMIN] Unknown option '%s', use 'hooks', 'cmds' or 'reset'\n", args.c_str(1));
+		QMM_RET_SUPERCEDE(1);
+	}
+
+	player_clientprint(clientnum, "[QADMIN] QAdmin statistics:\n");
+	player_clientprintf(clientnum, "[QADMIN] Client commands: %llu (%llu ignored by fast path)\n", (unsigned long long)g_counters.clientcmds, (unsigned long long)g_counters.fastrejects);
+	player_clientprintf(clientnum, "[QADMIN] Userinfo changes: %llu (%llu with no relevant changes)\n", (unsigned long long)(g_counters.userinfo_updates + g_counters.userinfo_skipped), (unsigned long long)g_counters.userinfo_skipped);
+	player_clientprintf(clientnum, "[QADMIN] Users: %zu (%zu from database), %llu automatically authenticated\n", g_users.size(), g_users.db.count, (unsigned long long)g_counters.autoauths);
+	player_clientprintf(clientnum, "[QADMIN] Bans: %zu (%llu connections rejected)\n", bans_count(), (unsigned long long)g_counters.banrejects);
+	player_clientprintf(clientnum, "[QADMIN] Ban checks: %llu (%llu passed the filter, %llu of those were false positives)\n", (unsigned long long)g_counters.banchecks, (unsigned long long)g_counters.banfilter_passes, (unsigned long long)g_counters.banfilter_false);
+	player_clientprintf(clientnum, "[QADMIN] Client output: %llu prints sent in %llu commands\n", (unsigned long long)g_counters.output_prints, (unsigned long long)g_counters.output_cmds);
+	player_clientprintf(clientnum, "[QADMIN] Timers: %zu pending\n", timer_count());
+	player_clientprintf(clientnum, "[QADMIN] Jobs: %zu running, %llu steps in %llu frames (%llu over budget)\n", jobs_count(), (unsigned long long)g_counters.job_steps, (unsigned long long)g_counters.job_frames, (unsigned long long)g_counters.job_overbudget);
+	if (g_maps.loaded)
+		player_clientprintf(clientnum, "[QADMIN] Maps: %zu\n", g_maps.maps.size());
+	player_clientprintf(clientnum, "[QADMIN] String functions: %s\n", str_kernel_name());
+	player_clientprint(clientnum, "[QADMIN] Use 'admin_stats hooks' for hook times, or 'admin_stats cmds' for command stats\n");
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_userlist(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	std::string match = "";
+int admin_userlist(intptr_t clientnum, int access, cmd_args args, bool say) {
+	std::string_view match;
 
 	int banaccess = player_has_access(clientnum, LEVEL_256);
 
 	// if a parameter was given, only display users matching it
 	if (args.size() > 1) {
 		match = args[1];
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Listing users matching '%s'...\n", match.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Listing users matching '%s'...\n", args.c_str(1));
 	}
 	else {
 		player_clientprint(clientnum, "[QADMIN] Listing users...\n");
@@ -505,20 +980,19 @@ int admin_userlist(intptr_t clientnum, int access, std::vector<std::string> args
 		for (auto playernum : players_with_name(match)) {
 			player_info& info = g_playerinfo[playernum];
 			if (banaccess)
-				player_clientprint(clientnum, QMM_VARARGS("[QADMIN] %3d: %-8d %-6s %-15s %s\n", playernum, info.access, info.authed ? "yes" : "no", info.ip.c_str(), info.name.c_str()));
+				player_clientprintf(clientnum, "[QADMIN] %3d: %-8d %-6s %-15s %s\n", (int)playernum, info.access, info.authed ? "yes" : "no", info.ip.c_str(), info.name.c_str());
 			else
-				player_clientprint(clientnum, QMM_VARARGS("[QADMIN] %3d: %-8d %-6s %s\n", playernum, info.access, info.authed ? "yes" : "no", info.name.c_str()));
+				player_clientprintf(clientnum, "[QADMIN] %3d: %-8d %-6s %s\n", (int)playernum, info.access, info.authed ? "yes" : "no", info.name.c_str());
 		}
 	}
 	// no name, list all
 	else {
-		for (auto& playerinfo : g_playerinfo) {
-			intptr_t playernum = playerinfo.first;
-			player_info& info = playerinfo.second;
+		for (intptr_t playernum : g_playerinfo) {
+			player_info& info = g_playerinfo[playernum];
 			if (banaccess)
-				player_clientprint(clientnum, QMM_VARARGS("[QADMIN] %3d: %-8d %-6s %-15s %s\n", playernum, info.access, info.authed ? "yes" : "no", info.ip.c_str(), info.name.c_str()));
+				player_clientprintf(clientnum, "[QADMIN] %3d: %-8d %-6s %-15s %s\n", (int)playernum, info.access, info.authed ? "yes" : "no", info.ip.c_str(), info.name.c_str());
 			else
-				player_clientprint(clientnum, QMM_VARARGS("[QADMIN] %3d: %-8d %-6s %s\n", playernum, info.access, info.authed ? "yes" : "no", info.name.c_str()));
+				player_clientprintf(clientnum, "[QADMIN] %3d: %-8d %-6s %s\n", (int)playernum, info.access, info.authed ? "yes" : "no", info.name.c_str());
 		}
 	}
 
@@ -526,48 +1000,66 @@ int admin_userlist(intptr_t clientnum, int access, std::vector<std::string> args
 }
 
 
-int admin_gag(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	std::string gagcmd = args[0];
-	std::string user = args[1];
+// ends a temporary gag
+static void ungag_timer(intptr_t clientnum) {
+	player_info& info = g_playerinfo[clientnum];
+	info.gagtimer = 0;
+	if (!info.gagged)
+		return;
+
+	info.gagged = false;
+	player_clientprint(clientnum, "[QADMIN] You are no longer gagged\n");
+	QMM_WRITEQMMLOG(QMMLOG_INFO, "Temporary gag on %s has ended\n", info.name.c_str());
+}
+
+
+int admin_gag(intptr_t clientnum, int access, cmd_args args, bool say) {
+	std::string_view user = args[1];
+	int minutes = args.size() > 2 ? atoi(args.c_str(2)) : 0;
 
 	std::vector<intptr_t> targets = players_with_name(user);
 	if (targets.size() == 0) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Match not found for '%s'\n", user.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Match not found for '%s'\n", args.c_str(1));
 		QMM_RET_SUPERCEDE(1);
 	}
 	else if (targets.size() > 1) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Ambiguous match for '%s'\n", user.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Ambiguous match for '%s'\n", args.c_str(1));
 		QMM_RET_SUPERCEDE(1);
 	}
 
 	intptr_t targetclient = targets[0];
 
 	if (player_has_access(targetclient, ACCESS_IMMUNITY)) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Cannot gag %s, user has immunity\n", g_playerinfo[targetclient].name.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Cannot gag %s, user has immunity\n", g_playerinfo[targetclient].name.c_str());
 	}
 	else if (g_playerinfo[targetclient].gagged) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] %s is already gagged\n", g_playerinfo[targetclient].name.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] %s is already gagged\n", g_playerinfo[targetclient].name.c_str());
 	}
 	else {
-		g_playerinfo[targetclient].gagged = true;
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] %s has been gagged\n", g_playerinfo[targetclient].name.c_str()));
+		player_info& target = g_playerinfo[targetclient];
+		target.gagged = true;
+		if (minutes > 0) {
+			target.gagtimer = timer_add((uint64_t)minutes * 60 * 1000, ungag_timer, targetclient);
+			player_clientprintf(clientnum, "[QADMIN] %s has been gagged for %d minute(s)\n", target.name.c_str(), minutes);
+		}
+		else
+			player_clientprintf(clientnum, "[QADMIN] %s has been gagged\n", target.name.c_str());
 	}
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_ungag(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	std::string ungagcmd = args[0];
-	std::string user = args[1];
+int admin_ungag(intptr_t clientnum, int access, cmd_args args, bool say) {
+	std::string_view user = args[1];
 
 	std::vector<intptr_t> targets = players_with_name(user);
 	if (targets.size() == 0) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Match not found for '%s'\n", user.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Match not found for '%s'\n", args.c_str(1));
 		QMM_RET_SUPERCEDE(1);
 	}
 	else if (targets.size() > 1) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Ambiguous match for '%s'\n", user.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Ambiguous match for '%s'\n", args.c_str(1));
 		QMM_RET_SUPERCEDE(1);
 	}
 
@@ -575,22 +1067,24 @@ int admin_ungag(intptr_t clientnum, int access, std::vector<std::string> args, b
 
 	if (g_playerinfo[targetclient].gagged) {
 		g_playerinfo[targetclient].gagged = false;
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] %s has been ungagged\n", g_playerinfo[targetclient].name.c_str()));
+		timer_cancel(g_playerinfo[targetclient].gagtimer);
+		g_playerinfo[targetclient].gagtimer = 0;
+		player_clientprintf(clientnum, "[QADMIN] %s has been ungagged\n", g_playerinfo[targetclient].name.c_str());
 	} else {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] %s is not gagged\n", g_playerinfo[targetclient].name.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] %s is not gagged\n", g_playerinfo[targetclient].name.c_str());
 	}
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_currentmap(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	player_clientprint(say ? -1 : clientnum, QMM_VARARGS("[QADMIN] The current map is: %s\n", QMM_GETSTRCVAR("mapname")));
+int admin_currentmap(intptr_t clientnum, int access, cmd_args args, bool say) {
+	player_clientprintf(say ? -1 : clientnum, "[QADMIN] The current map is: %s\n", QMM_GETSTRCVAR("mapname"));
 	QMM_RETURN(say ? QMM_IGNORED : QMM_SUPERCEDE, 1);
 }
 
 
-int admin_timeleft(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
+int admin_timeleft(intptr_t clientnum, int access, cmd_args args, bool say) {
 	intptr_t timelimit = g_syscall(G_CVAR_VARIABLE_INTEGER_VALUE, "timelimit");
 	if (!timelimit) {
 		player_clientprint(say ? -1 : clientnum, "[QADMIN] There is no time limit.\n");
@@ -601,49 +1095,47 @@ int admin_timeleft(intptr_t clientnum, int access, std::vector<std::string> args
 	if (timeleft <= 0)
 		player_clientprint(say ? -1 : clientnum, "[QADMIN] Time limit has been reached\n");
 	else
-		player_clientprint(say ? -1 : clientnum, QMM_VARARGS("[QADMIN] Time remaining: %lu minute(s) %lu second(s)\n", timeleft / 60, timeleft % 60));
+		player_clientprintf(say ? -1 : clientnum, "[QADMIN] Time remaining: %lu minute(s) %lu second(s)\n", timeleft / 60, timeleft % 60);
 
 	QMM_RETURN(say ? QMM_IGNORED : QMM_SUPERCEDE, 1);
 }
 
 
-void handle_vote_map(intptr_t winner, int winvotes, int totalvotes, void* param) {
-	std::string map = *(std::string*)param;
+void handle_vote_map(intptr_t winner, int winvotes, int totalvotes, const vote_param& param) {
+	const std::string& map = std::get<vote_map_param>(param).map;
 	if (winner == 1) {
-		player_clientprint(-1, QMM_VARARGS("[QADMIN] Vote to change map to %s was successful\n", map.c_str()));
-		g_syscall(G_SEND_CONSOLE_COMMAND, EXEC_APPEND, QMM_VARARGS("map \"%s\"\n", map.c_str()));
+		player_clientprintf(-1, "[QADMIN] Vote to change map to %s was successful\n", map.c_str());
+		server_command("map \"%s\"\n", map.c_str());
 	} else {
-		player_clientprint(-1, QMM_VARARGS("[QADMIN] Vote to change map to %s has failed\n", map.c_str()));
+		player_clientprintf(-1, "[QADMIN] Vote to change map to %s has failed\n", map.c_str());
 	}
 }
 
 
-int admin_vote_map(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	// this is static so that it still exists when passed to handle_vote_map as param
-	static std::string map;
-
-	int time = (int)QMM_GETINTCVAR("admin_vote_map_time");
+int admin_vote_map(intptr_t clientnum, int access, cmd_args args, bool say) {
+	int time = g_admin_vote_map_time.integer;
 
-	map = args[1];
+	std::string map(args[1]);
 
 	if (!is_valid_map(map)) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Unknown map '%s'\n", map.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Unknown map '%s'\n", map.c_str());
 		QMM_RET_SUPERCEDE(1);
 	}
 
-	if (!g_vote.inuse) {
-		player_clientprint(-1, QMM_VARARGS("[QADMIN] A %d second vote has been started to changed map to %s\n", time, map.c_str()));
-		player_clientprint(-1, "[QADMIN] Type 'castvote 1' for YES, or 'castvote 2' for NO\n");
+	int id = vote_start(clientnum, handle_vote_map, time, 2, vote_map_param{ map }, "change map to " + map);
+	if (id) {
+		std::string cmd = vote_cmd(id);
+		player_clientprintf(-1, "[QADMIN] A %d second vote has been started to change map to %s\n", time, map.c_str());
+		player_clientprintf(-1, "[QADMIN] Type '%s 1' for YES, or '%s 2' for NO\n", cmd.c_str(), cmd.c_str());
 	}
 
-	vote_start(clientnum, handle_vote_map, time, 2, (void*)&map);
-
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-void handle_vote_kick(intptr_t winner, int winvotes, int totalvotes, void* param) {
-	int clientnum = (int)(intptr_t)param;
+void handle_vote_kick(intptr_t winner, int winvotes, int totalvotes, const vote_param& param) {
+	const vote_kick_param& kick = std::get<vote_kick_param>(param);
+	intptr_t clientnum = kick.clientnum;
 	
 	// user may have authed and gotten immunity during the vote,
 	// but don't mention it, just make the vote fail
@@ -651,25 +1143,25 @@ void handle_vote_kick(intptr_t winner, int winvotes, int totalvotes, void* param
 		winner = 0;
 
 	if (winner == 1 && winvotes) {
-		player_clientprint(-1, QMM_VARARGS("[QADMIN] Vote to kick %s was successful\n", g_playerinfo[clientnum].name));
+		player_clientprintf(-1, "[QADMIN] Vote to kick %s was successful\n", kick.name.c_str());
 		player_kick(clientnum, "Kicked due to vote.");
 	} else {
-		player_clientprint(-1, QMM_VARARGS("[QADMIN] Vote to kick %s has failed\n", g_playerinfo[clientnum].name));
+		player_clientprintf(-1, "[QADMIN] Vote to kick %s has failed\n", kick.name.c_str());
 	}
 }
 
 
-int admin_vote_kick(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	int votetime = (int)QMM_GETINTCVAR("admin_vote_kick_time");
-	std::string user = args[1];
+int admin_vote_kick(intptr_t clientnum, int access, cmd_args args, bool say) {
+	int votetime = g_admin_vote_kick_time.integer;
+	std::string_view user = args[1];
 
 	std::vector<intptr_t> targets = players_with_name(user);
 	if (targets.size() == 0) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Match not found for '%s'\n", user.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Match not found for '%s'\n", args.c_str(1));
 		QMM_RET_SUPERCEDE(1);
 	}
 	else if (targets.size() > 1) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Ambiguous match for '%s'\n", user.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Ambiguous match for '%s'\n", args.c_str(1));
 		QMM_RET_SUPERCEDE(1);
 	}
 
@@ -679,31 +1171,76 @@ int admin_vote_kick(intptr_t clientnum, int access, std::vector<std::string> arg
 	// the user's immunity is also checked in the vote
 	// handler in case he auths before the vote ends
 	if (player_has_access(targetclient, ACCESS_IMMUNITY)) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Cannot kick %s, user has immunity\n", g_playerinfo[targetclient].name.c_str()));
+		player_clientprintf(clientnum, "[QADMIN] Cannot kick %s, user has immunity\n", g_playerinfo[targetclient].name.c_str());
 		QMM_RET_SUPERCEDE(1);
 	}
 
-	if (!g_vote.inuse) {
-		player_clientprint(-1, QMM_VARARGS("[QADMIN] A %d second vote has been started to kick %s\n", votetime, g_playerinfo[targetclient].name.c_str()));
-		player_clientprint(-1, "[QADMIN] Type 'castvote 1' for YES, or 'castvote 2' for NO\n");
+	const std::string& name = g_playerinfo[targetclient].name;
+	int id = vote_start(clientnum, handle_vote_kick, votetime, 2, vote_kick_param{ targetclient, name }, "kick " + name);
+	if (id) {
+		std::string cmd = vote_cmd(id);
+		player_clientprintf(-1, "[QADMIN] A %d second vote has been started to kick %s\n", votetime, name.c_str());
+		player_clientprintf(-1, "[QADMIN] Type '%s 1' for YES, or '%s 2' for NO\n", cmd.c_str(), cmd.c_str());
 	}
-	
-	vote_start(clientnum, handle_vote_kick, votetime, 2, (void*)targetclient);
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
-int admin_vote_abort(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
-	player_clientprint(-1, "[QADMIN] The current vote has been canceled\n");
-	g_vote.inuse = false;
+void handle_vote_custom(intptr_t winner, int winvotes, int totalvotes, const vote_param& param) {
+	const vote_custom_param& custom = std::get<vote_custom_param>(param);
+	if (!winner)
+		player_clientprintf(-1, "[QADMIN] Vote \"%s\" ended with no votes\n", custom.question.c_str());
+	else
+		player_clientprintf(-1, "[QADMIN] Vote \"%s\" result: %s (%d of %d votes)\n", custom.question.c_str(), custom.options[winner - 1].c_str(), winvotes, totalvotes);
+}
+
+
+int admin_vote_custom(intptr_t clientnum, int access, cmd_args args, bool say) {
+	int votetime = g_admin_vote_custom_time.integer;
+
+	// the question and options can be quoted to include spaces. args has already been split on every
+	// space, so use the engine's own arguments, or split chat text again since it still has its quotes
+	std::vector<std::string> words = say ? str_split_quoted(str_join(args, 1)) : parse_argv_after(args[0]);
+	if (words.size() < 3) {
+		player_clientprint(clientnum, "[QADMIN] A vote needs a question and at least 2 options\n");
+		QMM_RET_SUPERCEDE(1);
+	}
+
+	vote_custom_param custom;
+	custom.question = words[0];
+	custom.options.assign(words.begin() + 1, words.end());
+
+	if (custom.options.size() > MAX_CHOICES) {
+		player_clientprintf(clientnum, "[QADMIN] A vote can have at most %d options\n", MAX_CHOICES);
+		QMM_RET_SUPERCEDE(1);
+	}
+
+	int choices = (int)custom.options.size();
+	std::string desc = "\"" + custom.question + "\"";
+	int id = vote_start(clientnum, handle_vote_custom, votetime, choices, std::move(custom), desc);
+	if (id) {
+		const vote_custom_param& started = std::get<vote_custom_param>(g_votes[id - 1].param);
+		std::string cmd = vote_cmd(id);
+		player_clientprintf(-1, "[QADMIN] A %d second vote has been started: %s\n", votetime, started.question.c_str());
+		for (int i = 0; i < choices; i++)
+			player_clientprintf(-1, "[QADMIN] %d: %s\n", i + 1, started.options[i].c_str());
+		player_clientprintf(-1, "[QADMIN] Type '%s <option>' to vote\n", cmd.c_str());
+	}
+
+	QMM_RET_SUPERCEDE(1);
+}
+
+
+int admin_vote_abort(intptr_t clientnum, int access, cmd_args args, bool say) {
+	vote_abort(clientnum, args.size() > 1 ? atoi(args.c_str(1)) : 0);
 
 	QMM_RET_SUPERCEDE(1);
 }
 
 
 // say handler (need to handle subcommands)
-int say(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
+int say(intptr_t clientnum, int access, cmd_args args, bool say) {
 	if (g_playerinfo[clientnum].gagged) {
 		player_clientprint(clientnum, "[QADMIN] Sorry, you have been gagged.\n");
 		QMM_RET_SUPERCEDE(1);
@@ -714,42 +1251,44 @@ int say(intptr_t clientnum, int access, std::vector<std::string> args, bool say)
 		QMM_RET_SUPERCEDE(1);
 
 	// get new list of args without the first ("say")
-	args = std::vector<std::string>(args.begin() + 1, args.end());
-
-	std::string command = args[0];
-
-	// loop through all registered "say" commands
-	for (auto& saycmd : g_saycmds) {
-		// if we found the command
-		if (str_striequal(saycmd.cmd, command)) {
-			// if the client has access, run handler func (get return value, func will set result flag)
-			if (player_has_access(clientnum, saycmd.reqaccess)) {
-				// only run handler func if we provided enough args
-				if ((int)args.size() < (saycmd.minargs + 1))
-					QMM_RET_IGNORED(0);
-				else
-					return (saycmd.func)(clientnum, saycmd.reqaccess, args, true);	// true = say command
-			}
+	args = args.sub(1);
+
+	std::string_view command = args[0];
+
+	// look up in registered "say" commands
+	const cmd_info* saycmd = cmd_index_find(s_saycmd_index, command);
+	if (saycmd) {
+		// if the client has access, run handler func (get return value, func will set result flag)
+		if (player_has_access(clientnum, saycmd->reqaccess)) {
+			// only run handler func if we provided enough args
+			if ((int)args.size() < (saycmd->minargs + 1))
+				QMM_RET_IGNORED(0);
+			else
+				return cmd_run(saycmd, clientnum, args, true);	// true = say command
+		}
 
-			// if client doesn't have access, give warning message
-			player_clientprint(clientnum, QMM_VARARGS("[QADMIN] You do not have access to that command: '%s'\n", saycmd.cmd));
+		// if client doesn't have access, give warning message
+		saycmd->stats.denied++;
+		player_clientprintf(clientnum, "[QADMIN] You do not have access to that command: '%s'\n", saycmd->cmd);
 
-			QMM_RET_SUPERCEDE(1);
-		}
+		QMM_RET_SUPERCEDE(1);
 	}
 
 	QMM_RET_IGNORED(0);
 }
 
 
-int castvote(intptr_t clientnum, int access, std::vector<std::string> args, bool say) {
+int castvote(intptr_t clientnum, int access, cmd_args args, bool say) {
 	if (clientnum == SERVER_CONSOLE) {
 		player_clientprint(clientnum, "[QADMIN] Trying to vote from the server console, eh?\n");
 		QMM_RET_SUPERCEDE(1);
 	}
 
-	std::string vote = args[1];
-	vote_add(clientnum, atoi(vote.c_str()));
+	// "castvote <option>" or "castvote <id> <option>"
+	if (args.size() > 2)
+		vote_add(clientnum, atoi(args.c_str(1)), atoi(args.c_str(2)));
+	else
+		vote_add(clientnum, 0, atoi(args.c_str(1)));
 
 	QMM_RET_SUPERCEDE(1);		
 }
@@ -758,22 +1297,24 @@ int castvote(intptr_t clientnum, int access, std::vector<std::string> args, bool
 // register command handlers
 // moved into alphabetical order to make admin_help a bit easier
 std::vector<cmd_info> g_admincmds = {
-	{ "admin_ban",			admin_ban,			LEVEL_256,	1, "admin_ban <name> [message]", "Bans the specified user by IP" },
-	{ "admin_banip",		admin_banip,		LEVEL_256,	1, "admin_banip <ip> [message]", "Bans the specified IP" },
+	{ "admin_ban",			admin_ban,			LEVEL_256,	1, "admin_ban <name> [message]", "Bans the specified user by IP and GUID" },
+	{ "admin_banid",		admin_banid,		LEVEL_256,	1, "admin_banid <guid> [message]", "Bans the specified GUID" },
+	{ "admin_banip",		admin_banip,		LEVEL_256,	1, "admin_banip <ip[/prefix]> [message]", "Bans the specified IP or IP range" },
 	{ "admin_cfg",			admin_cfg,			LEVEL_512,	1, "admin_cfg <file.cfg>", "Executes the given .cfg file on the server" },
 	{ "admin_chat",			admin_chat,			LEVEL_64,	1, "admin_chat <text>", "Sends the message to all admins with admin_chat access" },
 	{ "admin_csay",			admin_csay,			LEVEL_64,	1, "admin_csay <text>", "Displays message to all players in center of screen" },
 	{ "admin_currentmap",	admin_currentmap,	LEVEL_0,	0, "admin_currentmap", "Displays current map" },
 	{ "admin_fraglimit",	admin_fraglimit,	LEVEL_2,	1, "admin_fraglimit <value>", "Sets the server's fraglimit" },
 	{ "admin_friendlyfire",	admin_friendlyfire,	LEVEL_32,	1, "admin_friendlyfire <value>", "Sets the server's friendlyfire" },
-	{ "admin_gag",			admin_gag,			LEVEL_2048,	1, "admin_gag <name>", "Gags the specified player from speaking" },
+	{ "admin_gag",			admin_gag,			LEVEL_2048,	1, "admin_gag <name> [minutes]", "Gags the specified player from speaking, optionally for a number of minutes" },
 	{ "admin_gametype",		admin_gametype,		LEVEL_32,	1, "admin_gametype <value>", "Sets the server's gametype" },
 	{ "admin_gravity",		admin_gravity,		LEVEL_32,	1, "admin_gravity <value>", "Sets the server's gravity" },
 	{ "admin_help",			admin_help,			LEVEL_0,	0, "admin_help [start]", "Displays commands you have access to" },
 	{ "admin_hostname",		admin_hostname,		LEVEL_512,	1, "admin_hostname <new name>", "Sets the server's hostname" },
 	{ "admin_kick",			admin_kick,			LEVEL_128,	1, "admin_kick <name> [message]", "Kicks name from the server" },
+	{ "admin_listbans",		admin_listbans,		LEVEL_256,	0, "admin_listbans [start]", "Lists QAdmin bans, 50 at a time from ban number start (1 = first)" },
 #ifndef GAME_NO_FS_GETFILELIST
-	{ "admin_listmaps",		admin_listmaps,		LEVEL_0,	0, "admin_listmaps", "Lists all maps on the server" },
+	{ "admin_listmaps",		admin_listmaps,		LEVEL_0,	0, "admin_listmaps [start]", "Lists the maps on the server" },
 #endif
 	{ "admin_login",		admin_login,		LEVEL_0,	1, "admin_login <pass>", "Logs you in to get access" },
 	{ "admin_map",			admin_map,			LEVEL_8,	1, "admin_map <map>", "Changes to the given map" },
@@ -781,18 +1322,22 @@ std::vector<cmd_info> g_admincmds = {
 	{ "admin_psay",			admin_psay,			LEVEL_64,	2, "admin_psay <name> <text>", "Sends the message to specified player" },
 	{ "admin_nopass",		admin_pass,			LEVEL_16,	0, "admin_nopass", "Clears the server password" },
 	{ "admin_rcon",			admin_rcon,			LEVEL_65536,1, "admin_rcon <command>", "Executes the command on the server" },
-	{ "admin_reload",		admin_reload,		LEVEL_4,	0, "admin_reload", "Reloads various QAdmin configs and cvars" },
+	{ "admin_reload",		admin_reload,		LEVEL_4,	0, "admin_reload [force]", "Reloads various QAdmin configs and cvars (force reloads users even if unchanged)" },
+	{ "admin_savedb",		admin_savedb,		LEVEL_65536,0, "admin_savedb [file]", "Writes all user entries to the user database file" },
 	{ "admin_say",			admin_say,			LEVEL_64,	1, "admin_say <text>", "Sends the message to all players" },
+	{ "admin_stats",		admin_stats,		LEVEL_4,	0, "admin_stats [hooks|cmds|reset]", "Displays QAdmin internal statistics, hook times or command stats" },
+	{ "admin_tempban",		admin_tempban,		LEVEL_256,	2, "admin_tempban <name> <minutes> [message]", "Bans the specified user by IP and GUID for a number of minutes" },
 	{ "admin_timeleft",		admin_timeleft,		LEVEL_0,	0, "admin_timeleft", "Displays the time left on this map" },
 	{ "admin_timelimit",	admin_timelimit,	LEVEL_2,	1, "admin_timelimit <value>", "Sets the server's timelimit" },
-	{ "admin_unban",		admin_unban,		LEVEL_256,	1, "admin_unban <ip>", "Unbans the specified IP" },
+	{ "admin_unban",		admin_unban,		LEVEL_256,	1, "admin_unban <ip[/prefix]|guid>", "Unbans the specified IP, IP range or GUID" },
 	{ "admin_ungag",		admin_ungag,		LEVEL_2048,	1, "admin_ungag <name>", "Ungags the specified player" },
 	{ "admin_userlist",		admin_userlist,		LEVEL_0,	0, "admin_userlist [name]", "Lists all users on the server that match 'name'" },
-	{ "admin_vote_abort",	admin_vote_abort,	LEVEL_2,	1, "admin_vote_abort", "Aborts the current map or kick vote" },
-	{ "admin_vote_cancel",	admin_vote_abort,	LEVEL_2,	1, nullptr, nullptr },
+	{ "admin_vote_abort",	admin_vote_abort,	LEVEL_2,	0, "admin_vote_abort [id]", "Aborts a running vote" },
+	{ "admin_vote_cancel",	admin_vote_abort,	LEVEL_2,	0, nullptr, nullptr },
+	{ "admin_vote_custom",	admin_vote_custom,	LEVEL_64,	3, "admin_vote_custom <question> <option1> <option2> [option3...]", "Initiates a vote with up to 9 options (quote any with spaces)" },
 	{ "admin_vote_kick",	admin_vote_kick,	LEVEL_1,	1, "admin_vote_kick <user>", "Initiates a vote to kick the user" },
 	{ "admin_vote_map",		admin_vote_map,		LEVEL_1,	1, "admin_vote_map <map>", "Initiates a vote to change to the map" },
-	{ "castvote",			castvote,			LEVEL_1,	1, "castvote <option>", "Places a vote for the given option" },
+	{ "castvote",			castvote,			LEVEL_1,	1, "castvote [id] <option>", "Places a vote for the given option" },
 
 	{ "say",				say,				LEVEL_0,	0, nullptr, nullptr },
 };
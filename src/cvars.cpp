@@ -0,0 +1,84 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#define _CRT_SECURE_NO_WARNINGS 1
+
+#include <qmmapi.h>
+
+#include "version.h"
+#include "game.h"
+
+#include <string>
+#include <cstdlib>
+#include "main.h"
+#include "cmds.h"
+#include "cvars.h"
+
+cached_cvar g_admin_default_access = { "admin_default_access", "1", CVAR_ARCHIVE, nullptr };
+cached_cvar g_admin_vote_kick_time = { "admin_vote_kick_time", "30", CVAR_ARCHIVE, nullptr };
+cached_cvar g_admin_vote_map_time = { "admin_vote_map_time", "60", CVAR_ARCHIVE, nullptr };
+cached_cvar g_admin_vote_custom_time = { "admin_vote_custom_time", "60", CVAR_ARCHIVE, nullptr };
+cached_cvar g_admin_config_file = { "admin_config_file", "qmmaddons/qadmin/config/qadmin.cfg", CVAR_ARCHIVE, nullptr };
+cached_cvar g_admin_db_file = { "admin_db_file", "qmmaddons/qadmin/config/qadmin.db", CVAR_ARCHIVE, nullptr };
+cached_cvar g_admin_auto_auth = { "admin_auto_auth", "0", CVAR_ARCHIVE, nullptr };
+cached_cvar g_admin_ban_file = { "admin_ban_file", "qmmaddons/qadmin/config/bans.txt", CVAR_ARCHIVE, nullptr };
+cached_cvar g_admin_output_budget = { "admin_output_budget", "2048", CVAR_ARCHIVE, nullptr };
+cached_cvar g_admin_job_budget = { "admin_job_budget", "1000", CVAR_ARCHIVE, nullptr };
+cached_cvar g_admin_profile = { "admin_profile", "0", CVAR_ARCHIVE, nullptr };
+cached_cvar g_admin_slow_cmd_time = { "admin_slow_cmd_time", "5000", CVAR_ARCHIVE, nullptr };
+cached_cvar g_admin_gagged_cmds = { "admin_gagged_cmds", "say_team,tell,vsay,vsay_team,vtell,vosay,vosay_team,votell,vtaunt", CVAR_ARCHIVE, gag_build };
+
+static cached_cvar* s_cvars[] = {
+	&g_admin_default_access,
+	&g_admin_vote_kick_time,
+	&g_admin_vote_map_time,
+	&g_admin_vote_custom_time,
+	&g_admin_config_file,
+	&g_admin_db_file,
+	&g_admin_auto_auth,
+	&g_admin_ban_file,
+	&g_admin_output_budget,
+	&g_admin_job_budget,
+	&g_admin_profile,
+	&g_admin_slow_cmd_time,
+	&g_admin_gagged_cmds,
+};
+
+
+// re-read a cvar's value, returns true if it changed
+static bool cvar_refresh(cached_cvar& cvar) {
+	const char* value = QMM_GETSTRCVAR(cvar.name);
+	if (cvar.string == value)
+		return false;
+
+	cvar.string = value;
+	cvar.integer = atoi(value);
+	return true;
+}
+
+
+// register all cached cvars with the engine and read their initial values
+void cvars_register() {
+	for (auto cvar : s_cvars) {
+		g_syscall(G_CVAR_REGISTER, nullptr, cvar->name, cvar->defvalue, cvar->flags);
+		cvar_refresh(*cvar);
+	}
+}
+
+
+// refresh all cached cvars and call change handlers for any that changed
+// this is a plain string compare per cvar, since not every supported engine has vmCvar_t modification counts
+void cvars_update() {
+	for (auto cvar : s_cvars) {
+		if (cvar_refresh(*cvar) && cvar->onchange)
+			cvar->onchange(cvar->string.c_str());
+	}
+}
@@ -0,0 +1,279 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#define _CRT_SECURE_NO_WARNINGS 1
+
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <cstdio>
+#include "ip.h"
+
+
+bool ip_addr::operator==(const ip_addr& other) const {
+	return !memcmp(bytes, other.bytes, sizeof(bytes));
+}
+
+
+size_t ip_addr_hash::operator()(const ip_addr& addr) const {
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+	for (auto b : addr.bytes) {
+		hash ^= b;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+
+// parse a decimal number of at most maxdigits digits, no larger than max
+static bool parse_num(std::string_view str, int maxdigits, int max, int& num) {
+	if (str.empty() || (int)str.size() > maxdigits)
+		return false;
+	num = 0;
+	for (auto c : str) {
+		if (c < '0' || c > '9')
+			return false;
+		num = num * 10 + (c - '0');
+	}
+	return num <= max;
+}
+
+
+// parse dotted-quad IPv4 into 4 bytes
+static bool parse_v4(std::string_view str, uint8_t* out) {
+	for (int i = 0; i < 4; i++) {
+		size_t dot = i < 3 ? str.find('.') : str.size();
+		if (dot == std::string_view::npos)
+			return false;
+		int octet;
+		if (!parse_num(str.substr(0, dot), 3, 255, octet))
+			return false;
+		out[i] = (uint8_t)octet;
+		str.remove_prefix(i < 3 ? dot + 1 : dot);
+	}
+	return true;
+}
+
+
+static int hex_value(char c) {
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+
+// parse IPv6 (with optional "::" and trailing dotted-quad) into 16 bytes
+static bool parse_v6(std::string_view str, uint8_t* out) {
+	uint8_t head[16] = {}, tail[16] = {};
+	int nhead = 0, ntail = 0;
+	bool compressed = false;
+
+	if (str.substr(0, 2) == "::") {
+		compressed = true;
+		str.remove_prefix(2);
+	}
+
+	while (!str.empty()) {
+		uint8_t* dest = compressed ? tail : head;
+		int& n = compressed ? ntail : nhead;
+
+		size_t colon = str.find(':');
+		std::string_view group = str.substr(0, colon);
+
+		// trailing IPv4 part
+		if (colon == std::string_view::npos && group.find('.') != std::string_view::npos) {
+			if (n + 4 > 16 || !parse_v4(group, dest + n))
+				return false;
+			n += 4;
+			break;
+		}
+
+		if (group.empty() || group.size() > 4 || n + 2 > 16)
+			return false;
+		int value = 0;
+		for (auto c : group) {
+			int h = hex_value(c);
+			if (h < 0)
+				return false;
+			value = value * 16 + h;
+		}
+		dest[n++] = (uint8_t)(value >> 8);
+		dest[n++] = (uint8_t)value;
+
+		if (colon == std::string_view::npos)
+			break;
+		str.remove_prefix(colon + 1);
+
+		// "::" in the middle
+		if (!str.empty() && str[0] == ':') {
+			if (compressed)
+				return false;
+			compressed = true;
+			str.remove_prefix(1);
+		}
+		// trailing single ':'
+		else if (str.empty())
+			return false;
+	}
+
+	if (compressed ? nhead + ntail > 14 : nhead != 16)
+		return false;
+
+	memset(out, 0, 16);
+	memcpy(out, head, nhead);
+	memcpy(out + 16 - ntail, tail, ntail);
+	return true;
+}
+
+
+// parse an address without port
+static bool parse_addr(std::string_view str, ip_addr& addr) {
+	ip_addr ret;
+	if (str.find(':') != std::string_view::npos) {
+		if (!parse_v6(str, ret.bytes))
+			return false;
+	}
+	else {
+		ret.bytes[10] = ret.bytes[11] = 0xFF;
+		if (!parse_v4(str, ret.bytes + 12))
+			return false;
+	}
+	addr = ret;
+	return true;
+}
+
+
+// parse an IPv4 or IPv6 address, with optional port ("1.2.3.4:27960" or "[::1]:27960")
+bool ip_parse(std::string_view str, ip_addr& addr) {
+	if (!str.empty() && str[0] == '[') {
+		size_t end = str.find(']');
+		if (end == std::string_view::npos)
+			return false;
+		return parse_addr(str.substr(1, end - 1), addr);
+	}
+
+	// a single colon is a port separator for IPv4
+	size_t colon = str.find(':');
+	if (colon != std::string_view::npos && str.find(':', colon + 1) == std::string_view::npos)
+		str = str.substr(0, colon);
+
+	return parse_addr(str, addr);
+}
+
+
+// parse an address with optional "/prefix" (IPv4 prefixes are 0-32, IPv6 are 0-128)
+// prefixlen is returned relative to the 128-bit address, and addr is masked to the prefix
+bool ip_parse_cidr(std::string_view str, ip_addr& addr, int& prefixlen) {
+	size_t slash = str.find('/');
+	if (!parse_addr(str.substr(0, slash), addr))
+		return false;
+
+	bool v4 = ip_is_v4(addr);
+	prefixlen = 128;
+	if (slash != std::string_view::npos) {
+		if (!parse_num(str.substr(slash + 1), 3, v4 ? 32 : 128, prefixlen))
+			return false;
+		if (v4)
+			prefixlen += IP_V4_PREFIX;
+	}
+
+	ip_mask(addr, prefixlen);
+	return true;
+}
+
+
+bool ip_is_v4(const ip_addr& addr) {
+	static const uint8_t v4prefix[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF };
+	return !memcmp(addr.bytes, v4prefix, sizeof(v4prefix));
+}
+
+
+// zero all bits after the first prefixlen bits
+void ip_mask(ip_addr& addr, int prefixlen) {
+	for (int i = 0; i < 16; i++) {
+		int bits = prefixlen - i * 8;
+		if (bits <= 0)
+			addr.bytes[i] = 0;
+		else if (bits < 8)
+			addr.bytes[i] &= (uint8_t)(0xFF << (8 - bits));
+	}
+}
+
+
+// check if addr is inside the net/prefixlen range
+bool ip_match(const ip_addr& addr, const ip_addr& net, int prefixlen) {
+	int full = prefixlen / 8;
+	if (memcmp(addr.bytes, net.bytes, full))
+		return false;
+	int bits = prefixlen % 8;
+	if (!bits)
+		return true;
+	uint8_t mask = (uint8_t)(0xFF << (8 - bits));
+	return (addr.bytes[full] & mask) == (net.bytes[full] & mask);
+}
+
+
+// value of bit n of the address (0 is the most significant)
+int ip_bit(const ip_addr& addr, int n) {
+	return (addr.bytes[n / 8] >> (7 - n % 8)) & 1;
+}
+
+
+// number of leading bits that a and b have in common, at most max
+int ip_common_bits(const ip_addr& a, const ip_addr& b, int max) {
+	int bits = 0;
+	for (int i = 0; i < 16 && bits < max; i++) {
+		uint8_t diff = a.bytes[i] ^ b.bytes[i];
+		if (!diff) {
+			bits += 8;
+			continue;
+		}
+		while (!(diff & 0x80)) {
+			diff <<= 1;
+			bits++;
+		}
+		break;
+	}
+	return bits < max ? bits : max;
+}
+
+
+std::string ip_to_str(const ip_addr& addr) {
+	char buf[64];
+	const uint8_t* b = addr.bytes;
+	if (ip_is_v4(addr)) {
+		snprintf(buf, sizeof(buf), "%d.%d.%d.%d", b[12], b[13], b[14], b[15]);
+		return buf;
+	}
+
+	// full form without "::" compression, leading zeros dropped
+	std::string ret;
+	for (int i = 0; i < 16; i += 2) {
+		snprintf(buf, sizeof(buf), i ? ":%x" : "%x", (b[i] << 8) | b[i + 1]);
+		ret += buf;
+	}
+	return ret;
+}
+
+
+// address with "/prefix" (relative to IPv4 for IPv4 addresses), or just the address for a single address
+std::string ip_cidr_to_str(const ip_addr& addr, int prefixlen) {
+	if (prefixlen >= 128)
+		return ip_to_str(addr);
+	if (ip_is_v4(addr) && prefixlen >= IP_V4_PREFIX)
+		prefixlen -= IP_V4_PREFIX;
+	return ip_to_str(addr) + "/" + std::to_string(prefixlen);
+}
@@ -0,0 +1,73 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#define _CRT_SECURE_NO_WARNINGS 1
+
+#include <qmmapi.h>
+
+#include "version.h"
+#include "game.h"
+
+#include <chrono>
+#include <deque>
+#include <utility>
+#include "main.h"
+#include "cvars.h"
+#include "jobs.h"
+
+typedef struct {
+	const char* name;
+	job_step step;
+} job_info;
+
+// jobs take turns running a step each
+static std::deque<job_info> s_jobs;
+
+
+// queue a job, its steps are run from jobs_frame() until one returns true
+void job_add(const char* name, job_step step) {
+	s_jobs.push_back({ name, std::move(step) });
+}
+
+
+// run job steps until admin_job_budget microseconds have passed, called every frame
+// at least one step is run each frame so jobs always make progress
+void jobs_frame() {
+	if (s_jobs.empty())
+		return;
+
+	auto start = std::chrono::steady_clock::now();
+	long long budget = g_admin_job_budget.integer;
+	long long elapsed = 0;
+	g_counters.job_frames++;
+
+	do {
+		job_info job = std::move(s_jobs.front());
+		s_jobs.pop_front();
+
+		g_counters.job_steps++;
+		if (job.step())
+			QMM_WRITEQMMLOG(QMMLOG_DEBUG, "Finished job \"%s\"\n", job.name);
+		else
+			s_jobs.push_back(std::move(job));
+
+		elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	} while (!s_jobs.empty() && elapsed < budget);
+
+	if (elapsed > budget)
+		g_counters.job_overbudget++;
+}
+
+
+// number of jobs not yet finished
+size_t jobs_count() {
+	return s_jobs.size();
+}
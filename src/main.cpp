@@ -22,6 +22,12 @@ Created By:
 #include <time.h>
 #include "main.h"
 #include "cmds.h"
+#include "cvars.h"
+#include "bans.h"
+#include "jobs.h"
+#include "profile.h"
+#include "timers.h"
+#include "users.h"
 #include "vote.h"
 #include "util.h"
 
@@ -49,15 +55,17 @@ gclient_t* g_clients = nullptr;
 intptr_t g_clientsize = 0;
 
 // qadmin player info and game userinfo strings
-std::map<intptr_t, player_info> g_playerinfo;
-std::vector<user_info> g_userinfo;
+player_table g_playerinfo;
+
+qadmin_counters g_counters = {};
+
+// clients whose connection was rejected by a ban (QMM_vmMain_Post skips them)
+static client_set s_rejected;
 
 // time the 
 time_t g_mapstart;
 time_t g_leveltime;
 
-std::vector<std::string> g_gaggedCmds;
-
 
 // first function called in plugin, give QMM the plugin info
 C_DLLEXPORT void QMM_Query(plugin_info** pinfo) {
@@ -80,6 +88,8 @@ C_DLLEXPORT void QMM_Detach() {
 
 // called before mod's vmMain (engine->mod)
 C_DLLEXPORT intptr_t QMM_vmMain(intptr_t cmd, intptr_t* args) {
+	prof_timer timer(PROF_VMMAIN, cmd);
+
 	// clear client info on disconnection
 	if (cmd == GAME_CLIENT_DISCONNECT) {
 		intptr_t clientnum = args[0];
@@ -87,8 +97,46 @@ C_DLLEXPORT intptr_t QMM_vmMain(intptr_t cmd, intptr_t* args) {
 		// ent->s.number is not set until CLIENT_BEGIN, so calculate based on edict_t*
 		clientnum = NUM_FROM_ENT(clientnum) - 1;
 #endif
-		if (g_playerinfo.count(clientnum))
-			g_playerinfo.erase(clientnum);
+		player_disconnect(clientnum);
+		vote_remove_client(clientnum);
+	}
+	// reject banned clients before the mod sees them
+	else if (cmd == GAME_CLIENT_CONNECT) {
+		intptr_t clientnum = args[0];
+#ifdef GAME_CLIENT_ENT_PTRS
+		// ent->s.number is not set until CLIENT_BEGIN, so calculate based on edict_t*
+		clientnum = NUM_FROM_ENT(clientnum) - 1;
+		char* userinfo = (char*)args[1];
+#else
+		char userinfo[MAX_INFO_STRING];
+		g_syscall(G_GET_USERINFO, clientnum, userinfo, sizeof(userinfo));
+#endif
+		static const char* const keys[] = { "ip", "cl_guid" };
+		std::string_view values[2];
+		info_scan(userinfo, keys, values, 2);
+
+		// bots and local clients have no address, so only check guid
+		ip_addr addr;
+		bool ipvalid = ip_parse(values[0], addr);
+		const ban_info* ban = ban_check(ipvalid ? &addr : nullptr, values[1], g_leveltime);
+		if (ban) {
+			static std::string reason;
+			reason = ban->reason.empty() ? "You are banned from this server" : "Banned: " + ban->reason;
+
+			QMM_WRITEQMMLOG(QMMLOG_INFO, "Rejected banned client %d (ip \"%.*s\", guid \"%.*s\"): %s\n", (int)clientnum, (int)values[0].size(), values[0].data(), (int)values[1].size(), values[1].data(), reason.c_str());
+			g_counters.banrejects++;
+			player_disconnect(clientnum);
+			s_rejected.set(clientnum);
+#ifdef GAME_CONNECT_RETURNS_BOOL
+			// idTech2 shows the client the "rejmsg" userinfo key
+			std::string rejmsg = "\\rejmsg\\" + str_sanitize(reason);
+			if (strlen(userinfo) + rejmsg.size() < MAX_INFO_STRING)
+				strcat(userinfo, rejmsg.c_str());
+			QMM_RET_SUPERCEDE(0);
+#else
+			QMM_RET_SUPERCEDE((intptr_t)reason.c_str());
+#endif
+		}
 	}
 	// handle client commands
 	else if (cmd == GAME_CLIENT_COMMAND) {
@@ -97,6 +145,10 @@ C_DLLEXPORT intptr_t QMM_vmMain(intptr_t cmd, intptr_t* args) {
 		// ent->s.number is not set until CLIENT_BEGIN, so calculate based on edict_t*
 		clientnum = NUM_FROM_ENT(clientnum) - 1;
 #endif
+		// don't bother tokenizing commands that QAdmin doesn't care about
+		if (!cmd_prefilter(clientnum))
+			QMM_RET_IGNORED(0);
+
 		return handlecommand(clientnum, parse_args(0));
 	}
 	// allow admin commands from console with "admin_cmd" or "a_c" commands
@@ -119,6 +171,11 @@ C_DLLEXPORT intptr_t QMM_vmMain(intptr_t cmd, intptr_t* args) {
 			return admin_adduser(au_name, parse_args(0 + firstarg));
 		else if (str_striequal(command, "admin_adduser_id"))
 			return admin_adduser(au_id, parse_args(0 + firstarg));
+		// sent by reload() after the config file
+		else if (str_striequal(command, "admin_reload_done")) {
+			reload_done();
+			QMM_RET_SUPERCEDE(1);
+		}
 	}
 	else if (cmd == GAME_INIT) {
 		QMM_WRITEQMMLOG(QMMLOG_INFO, "QAdmin v" QADMIN_QMM_VERSION " by " QADMIN_QMM_BUILDER " is loaded\n");
@@ -126,12 +183,8 @@ C_DLLEXPORT intptr_t QMM_vmMain(intptr_t cmd, intptr_t* args) {
 		// make version cvar
 		g_syscall(G_CVAR_REGISTER, nullptr, "admin_version", QADMIN_QMM_VERSION, CVAR_SERVERINFO | CVAR_ROM);
 
-		// other cvars
-		g_syscall(G_CVAR_REGISTER, nullptr, "admin_default_access", "1", CVAR_ARCHIVE);
-		g_syscall(G_CVAR_REGISTER, nullptr, "admin_vote_kick_time", "30", CVAR_ARCHIVE);
-		g_syscall(G_CVAR_REGISTER, nullptr, "admin_vote_map_time", "60", CVAR_ARCHIVE);
-		g_syscall(G_CVAR_REGISTER, nullptr, "admin_config_file", "qmmaddons/qadmin/config/qadmin.cfg", CVAR_ARCHIVE);
-		g_syscall(G_CVAR_REGISTER, nullptr, "admin_gagged_cmds", "say_team,tell,vsay,vsay_team,vtell,vosay,vosay_team,votell,vtaunt", CVAR_ARCHIVE);
+		// other cvars (cached, see cvars.cpp)
+		cvars_register();
 
 		time(&g_mapstart);
 		time(&g_leveltime);
@@ -139,8 +192,20 @@ C_DLLEXPORT intptr_t QMM_vmMain(intptr_t cmd, intptr_t* args) {
 	else if (cmd == GAME_RUN_FRAME) {
 		time(&g_leveltime);
 
-		if (g_vote.inuse && g_leveltime >= g_vote.finishtime)
-			vote_finish();
+		// refresh cached cvars (also rebuilds anything depending on them)
+		cvars_update();
+
+		// swap in reloaded users, if ready
+		reload_frame();
+
+		// run timers that are due (votes, temporary gags, ban expiry)
+		timer_frame();
+
+		// continue background jobs, within admin_job_budget
+		jobs_frame();
+
+		// send queued client output
+		player_flush_output();
 	}
 
 	QMM_RET_IGNORED(0);
@@ -149,6 +214,8 @@ C_DLLEXPORT intptr_t QMM_vmMain(intptr_t cmd, intptr_t* args) {
 
 // called after mod's vmMain (engine->mod)
 C_DLLEXPORT intptr_t QMM_vmMain_Post(intptr_t cmd, intptr_t* args) {
+	prof_timer timer(PROF_VMMAIN_POST, cmd);
+
 	// save client data on connection
 	// (this is here in _Post so that the game has a chance to do various info checking before we get the values)
 	if (cmd == GAME_CLIENT_CONNECT || cmd == GAME_CLIENT_USERINFO_CHANGED) {
@@ -162,29 +229,52 @@ C_DLLEXPORT intptr_t QMM_vmMain_Post(intptr_t cmd, intptr_t* args) {
 		g_syscall(G_GET_USERINFO, clientnum, userinfo, sizeof(userinfo));
 #endif
 
+		// connection was rejected in QMM_vmMain
+		if (cmd == GAME_CLIENT_CONNECT && s_rejected.test(clientnum)) {
+			s_rejected.reset(clientnum);
+			QMM_RET_IGNORED(0);
+		}
+
 		// if playerinfo is missing, make a new one
-		if (!g_playerinfo.count(clientnum)) {
-			g_playerinfo[clientnum] = {};
-			g_playerinfo[clientnum].access = 0;
-			g_playerinfo[clientnum].authed = false;
-			g_playerinfo[clientnum].gagged = false;
+		if (!g_playerinfo.has(clientnum))
+			g_playerinfo.add(clientnum);
+
+		// update ip/guid/name, only touching the ones that changed
+		player_info& info = g_playerinfo[clientnum];
+
+		static const char* const keys[] = { "ip", "cl_guid", "name" };
+		std::string_view values[3];
+		info_scan(userinfo, keys, values, 3);
+
+		bool updated = false;
+		bool idchanged = false;	// ip or guid changed, check auto-auth
+		if (values[0] != info.rawip) {
+			info.rawip = values[0];
+			player_set_ip(clientnum, values[0]);
+			updated = idchanged = true;
+		}
+		if (values[1] != info.guid) {
+			info.guid = values[1];
+			updated = idchanged = true;
+		}
+		if (values[2] != info.name) {
+			info.name = values[2];
+			info.stripname = strip_codes(info.name);
+			updated = true;
 		}
-		
-		// update ip/guid/name
-		player_info& info = g_playerinfo[clientnum]; 
-
-		std::string ip = QMM_INFOVALUEFORKEY(userinfo, "ip");
-		size_t colon = ip.find(':');
-		info.ip = colon != std::string::npos ? ip.substr(0, colon) : ip;
-		info.guid = QMM_INFOVALUEFORKEY(userinfo, "cl_guid");
-		info.name = QMM_INFOVALUEFORKEY(userinfo, "name");
-		info.stripname = strip_codes(info.name);
+
+		if (updated)
+			g_counters.userinfo_updates++;
+		else
+			g_counters.userinfo_skipped++;
+
+		if (idchanged && g_admin_auto_auth.integer)
+			player_auto_auth(clientnum);
 	}
 	// handle the game initialization (dependent on mod being loaded)
 	else if (cmd == GAME_INIT) {
-		g_syscall(G_SEND_CONSOLE_COMMAND, EXEC_APPEND, QMM_VARARGS("exec %s.cfg\n", QMM_GETSTRCVAR("mapname")));
-		// g_syscall(G_SEND_CONSOLE_COMMAND, EXEC_APPEND, "exec banned_guids.cfg\n");
-		
+		server_command("exec %s.cfg\n", QMM_GETSTRCVAR("mapname"));
+
 		reload();
 	}
 
@@ -194,6 +284,7 @@ C_DLLEXPORT intptr_t QMM_vmMain_Post(intptr_t cmd, intptr_t* args) {
 
 // called before engine's syscall (mod->engine)
 C_DLLEXPORT intptr_t QMM_syscall(intptr_t cmd, intptr_t* args) {
+	prof_timer timer(PROF_SYSCALL, cmd);
 
 	QMM_RET_IGNORED(0);
 }
@@ -201,5 +292,7 @@ C_DLLEXPORT intptr_t QMM_syscall(intptr_t cmd, intptr_t* args) {
 
 // called after engine's syscall (mod->engine)
 C_DLLEXPORT intptr_t QMM_syscall_Post(intptr_t cmd, intptr_t* args) {
+	prof_timer timer(PROF_SYSCALL_POST, cmd);
+
 	QMM_RET_IGNORED(0);
 }
@@ -0,0 +1,115 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#define _CRT_SECURE_NO_WARNINGS 1
+
+#include <qmmapi.h>
+
+#include "version.h"
+#include "game.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "main.h"
+#include "maps.h"
+#include "str.h"
+
+#define MAPLIST_START_SIZE 16384	// starting size of the file list buffer
+#define MAPLIST_MAX_SIZE 4194304	// largest file list buffer to try
+#define MAPLIST_MAX_NAME 256		// the list might be truncated if less than this much buffer is left
+
+map_catalog g_maps = {};
+
+
+static bool map_less(std::string_view a, std::string_view b) {
+	return str_stricmp(a, b) < 0;
+}
+
+
+// read the list of maps on the server into g_maps
+// called by reload(), so once per map and by admin_reload
+void maps_refresh() {
+#ifdef GAME_NO_FS_GETFILELIST
+	g_maps.loaded = false;
+#else
+	g_maps.names.clear();
+	g_maps.maps.clear();
+
+	// engines stop copying names when the buffer is full, so grow it until the list clearly fit
+	std::vector<char> list(MAPLIST_START_SIZE);
+	int numfiles = 0;
+	size_t used = 0;
+	while (true) {
+		numfiles = (int)g_syscall(G_FS_GETFILELIST, "maps", ".bsp", list.data(), (int)list.size());
+		used = 0;
+		for (int i = 0; i < numfiles && used < list.size(); i++)
+			used += strnlen(list.data() + used, list.size() - used) + 1;
+
+		if (used + MAPLIST_MAX_NAME < list.size() || list.size() >= MAPLIST_MAX_SIZE)
+			break;
+		list.resize(list.size() * 2);
+	}
+	if (used > list.size())
+		used = list.size();
+
+	// keep the names in one buffer and point into it
+	g_maps.names.assign(list.data(), used);
+	g_maps.maps.reserve(numfiles);
+	size_t pos = 0;
+	while (pos < g_maps.names.size()) {
+		std::string_view name(g_maps.names.data() + pos);
+		pos += name.size() + 1;
+
+		if (name.size() > 4 && str_striequal(name.substr(name.size() - 4), ".bsp"))
+			name.remove_suffix(4);
+		if (!name.empty())
+			g_maps.maps.push_back(name);
+	}
+	std::sort(g_maps.maps.begin(), g_maps.maps.end(), map_less);
+
+	g_maps.loaded = true;
+	QMM_WRITEQMMLOG(QMMLOG_INFO, "Found %zu maps\n", g_maps.maps.size());
+#endif
+}
+
+
+bool is_valid_map(std::string_view map) {
+	if (map.empty())
+		return false;
+
+	if (g_maps.loaded)
+		return std::binary_search(g_maps.maps.begin(), g_maps.maps.end(), map, map_less);
+
+// games that don't have readability into pak/pk3 files, just return true
+#ifdef GAME_MOHAA
+	return true;
+#else
+	if (G_FS_FOPEN_FILE < 0)
+		return true;
+#endif
+
+	fileHandle_t fmap;
+
+	str_buf<MAX_STRING_LENGTH> path;
+	if (!path.printf("maps/%.*s.bsp", (int)map.size(), map.data()))
+		return false;
+
+	intptr_t mapsize = (int)g_syscall(G_FS_FOPEN_FILE, path.c_str(), &fmap, FS_READ);
+	// doesn't exist, return immediately
+	if (mapsize < 0)
+		return false;
+	// if file was 0 bytes, we still need to close, but return false
+	g_syscall(G_FS_FCLOSE_FILE, fmap);
+	return mapsize ? true : false;
+}
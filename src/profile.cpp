@@ -0,0 +1,132 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#define _CRT_SECURE_NO_WARNINGS 1
+
+#include <qmmapi.h>
+
+#include "version.h"
+#include "game.h"
+
+#include <cstring>
+#include "main.h"
+#include "cvars.h"
+#include "profile.h"
+#include "util.h"
+
+// histograms for each hook, indexed by cmd, the last is for out-of-range cmds
+// these are fixed size, so recording a time never allocates
+static prof_hist s_vmmain[PROF_MAX_GAME_CMD + 1];
+static prof_hist s_vmmain_post[PROF_MAX_GAME_CMD + 1];
+static prof_hist s_syscall[PROF_MAX_SYSCALL_CMD + 1];
+static prof_hist s_syscall_post[PROF_MAX_SYSCALL_CMD + 1];
+
+typedef struct {
+	const char* name;
+	prof_hist* hists;
+	size_t maxcmd;
+} prof_hook;
+
+static const prof_hook s_hooks[PROF_HOOKS] = {
+	{ "QMM_vmMain", s_vmmain, PROF_MAX_GAME_CMD },
+	{ "QMM_vmMain_Post", s_vmmain_post, PROF_MAX_GAME_CMD },
+	{ "QMM_syscall", s_syscall, PROF_MAX_SYSCALL_CMD },
+	{ "QMM_syscall_Post", s_syscall_post, PROF_MAX_SYSCALL_CMD },
+};
+
+
+void prof_add(prof_hist& hist, uint64_t ns) {
+	int bucket = 0;
+	while (bucket < PROF_BUCKETS - 1 && (ns >> (bucket + 1)))
+		bucket++;
+
+	hist.buckets[bucket]++;
+	hist.count++;
+	hist.total += ns;
+	if (ns > hist.max)
+		hist.max = ns;
+}
+
+
+// upper bound of the bucket holding the given percentile (no higher than the max)
+uint64_t prof_percentile(const prof_hist& hist, int percent) {
+	if (!hist.count)
+		return 0;
+
+	uint64_t rank = (hist.count * percent + 99) / 100;
+	uint64_t seen = 0;
+	for (int i = 0; i < PROF_BUCKETS; i++) {
+		seen += hist.buckets[i];
+		if (seen >= rank) {
+			uint64_t bound = (uint64_t)1 << (i + 1);
+			return bound < hist.max ? bound : hist.max;
+		}
+	}
+	return hist.max;
+}
+
+
+void prof_record(prof_hookid hook, intptr_t cmd, uint64_t ns) {
+	const prof_hook& h = s_hooks[hook];
+	size_t index = (cmd >= 0 && (size_t)cmd < h.maxcmd) ? (size_t)cmd : h.maxcmd;
+	prof_add(h.hists[index], ns);
+}
+
+
+bool prof_enabled() {
+	return g_admin_profile.integer != 0;
+}
+
+
+void prof_reset() {
+	for (auto& h : s_hooks)
+		memset(h.hists, 0, (h.maxcmd + 1) * sizeof(prof_hist));
+}
+
+
+static void prof_print_hist(intptr_t clientnum, const char* label, const prof_hist& hist) {
+	player_clientprintf(clientnum, "[QADMIN] %s: %llu calls, p50 %lluns, p99 %lluns, max %lluns\n", label, (unsigned long long)hist.count,
+		(unsigned long long)prof_percentile(hist, 50), (unsigned long long)prof_percentile(hist, 99), (unsigned long long)hist.max);
+}
+
+
+// show each hook's times, in total and for each cmd value
+void prof_print(intptr_t clientnum) {
+	if (!prof_enabled())
+		player_clientprint(clientnum, "[QADMIN] Hook profiling is disabled (admin_profile 0)\n");
+
+	for (int hook = 0; hook < PROF_HOOKS; hook++) {
+		const prof_hook& h = s_hooks[hook];
+
+		prof_hist all = {};
+		for (size_t cmd = 0; cmd <= h.maxcmd; cmd++) {
+			const prof_hist& hist = h.hists[cmd];
+			for (int i = 0; i < PROF_BUCKETS; i++)
+				all.buckets[i] += hist.buckets[i];
+			all.count += hist.count;
+			all.total += hist.total;
+			if (hist.max > all.max)
+				all.max = hist.max;
+		}
+		prof_print_hist(clientnum, h.name, all);
+
+		for (size_t cmd = 0; cmd <= h.maxcmd; cmd++) {
+			if (!h.hists[cmd].count)
+				continue;
+			str_buf<32> label;
+			if (cmd == h.maxcmd)
+				label.printf("  other cmds");
+			else
+				label.printf("  cmd %d", (int)cmd);
+			prof_print_hist(clientnum, label.c_str(), h.hists[cmd]);
+		}
+	}
+}
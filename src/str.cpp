@@ -0,0 +1,334 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#define _CRT_SECURE_NO_WARNINGS 1
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include "str.h"
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+ #define STR_SSE2
+ #define STR_TARGET_SSE2 __attribute__((target("sse2")))
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+ #define STR_SSE2
+ #define STR_TARGET_SSE2
+ #include <intrin.h>
+#endif
+
+#ifdef STR_SSE2
+ #include <emmintrin.h>
+#endif
+
+
+// lowercase a single ASCII character (same result as tolower() in the "C" locale)
+static inline unsigned char fold(unsigned char c) {
+	return (unsigned char)(c - 'A') < 26 ? c + ('a' - 'A') : c;
+}
+
+
+// scalar versions
+
+// compare n bytes, case-insensitive
+// returns 0 if equal, otherwise <0 or >0 based on the first differing character
+static int cmp_scalar(const char* s1, const char* s2, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		unsigned char c1 = fold((unsigned char)s1[i]);
+		unsigned char c2 = fold((unsigned char)s2[i]);
+		if (c1 != c2)
+			return c1 < c2 ? -1 : 1;
+	}
+	return 0;
+}
+
+
+static bool find_scalar(const char* h, size_t hlen, const char* n, size_t nlen) {
+	unsigned char first = fold((unsigned char)n[0]);
+	for (size_t i = 0; i + nlen <= hlen; i++) {
+		if (fold((unsigned char)h[i]) == first && !cmp_scalar(h + i + 1, n + 1, nlen - 1))
+			return true;
+	}
+	return false;
+}
+
+
+#ifdef STR_SSE2
+// SSE2 versions, 16 bytes at a time with a scalar tail
+
+// lowercase 16 ASCII characters
+STR_TARGET_SSE2 static inline __m128i fold16(__m128i v) {
+	// shift 'A'-'Z' down to the bottom of the signed range so one signed compare finds them
+	__m128i shifted = _mm_add_epi8(v, _mm_set1_epi8((char)(0x80 - 'A')));
+	__m128i upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8((char)(0x80 + 26)));
+	return _mm_add_epi8(v, _mm_and_si128(upper, _mm_set1_epi8('a' - 'A')));
+}
+
+
+STR_TARGET_SSE2 static int cmp_sse2(const char* s1, const char* s2, size_t n) {
+	size_t i = 0;
+	for (; i + 16 <= n; i += 16) {
+		__m128i v1 = fold16(_mm_loadu_si128((const __m128i*)(s1 + i)));
+		__m128i v2 = fold16(_mm_loadu_si128((const __m128i*)(s2 + i)));
+		int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v1, v2));
+		if (mask != 0xFFFF) {
+			// index of first differing byte
+			size_t j = 0;
+			while (mask & (1 << j))
+				j++;
+			unsigned char c1 = fold((unsigned char)s1[i + j]);
+			unsigned char c2 = fold((unsigned char)s2[i + j]);
+			return c1 < c2 ? -1 : 1;
+		}
+	}
+	return cmp_scalar(s1 + i, s2 + i, n - i);
+}
+
+
+STR_TARGET_SSE2 static bool find_sse2(const char* h, size_t hlen, const char* n, size_t nlen) {
+	unsigned char first = fold((unsigned char)n[0]);
+	__m128i vfirst = _mm_set1_epi8((char)first);
+	// last index a match can start at
+	size_t last = hlen - nlen;
+
+	size_t i = 0;
+	// check 16 candidate start positions at once for the first character
+	for (; i + 16 <= hlen && i <= last; i += 16) {
+		__m128i v = fold16(_mm_loadu_si128((const __m128i*)(h + i)));
+		int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, vfirst));
+		while (mask) {
+			size_t j = 0;
+			while (!(mask & (1 << j)))
+				j++;
+			mask &= ~(1 << j);
+			if (i + j > last)
+				return false;
+			if (!cmp_sse2(h + i + j + 1, n + 1, nlen - 1))
+				return true;
+		}
+	}
+	for (; i <= last; i++) {
+		if (fold((unsigned char)h[i]) == first && !cmp_sse2(h + i + 1, n + 1, nlen - 1))
+			return true;
+	}
+	return false;
+}
+
+
+static bool cpu_has_sse2() {
+#if defined(__x86_64__) || defined(_M_X64)
+	return true;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[3] & (1 << 26)) != 0;
+#else
+	// this runs during static initialization, possibly before libgcc has initialized its cpu info
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("sse2");
+#endif
+}
+#endif // STR_SSE2
+
+
+// kernel functions, selected on load based on CPU features
+typedef struct {
+	const char* name;
+	int (*cmp)(const char* s1, const char* s2, size_t n);
+	bool (*find)(const char* h, size_t hlen, const char* n, size_t nlen);
+} str_kernel;
+
+static const str_kernel s_scalar = { "scalar", cmp_scalar, find_scalar };
+#ifdef STR_SSE2
+static const str_kernel s_sse2 = { "SSE2", cmp_sse2, find_sse2 };
+#endif
+
+
+static const str_kernel* select_kernel() {
+#ifdef STR_SSE2
+	if (cpu_has_sse2())
+		return &s_sse2;
+#endif
+	return &s_scalar;
+}
+
+static const str_kernel* s_kernel = select_kernel();
+
+
+const char* str_kernel_name() {
+	return s_kernel->name;
+}
+
+
+// switch to the named kernel, for tests and benchmarks
+// returns false if there is no such kernel or the CPU doesn't support it
+bool str_use_kernel(const char* name) {
+	if (!strcmp(name, s_scalar.name)) {
+		s_kernel = &s_scalar;
+		return true;
+	}
+#ifdef STR_SSE2
+	if (!strcmp(name, s_sse2.name) && cpu_has_sse2()) {
+		s_kernel = &s_sse2;
+		return true;
+	}
+#endif
+	return false;
+}
+
+
+int str_stristr(std::string_view haystack, std::string_view needle) {
+	if (needle.empty())
+		return 1;
+	if (needle.size() > haystack.size())
+		return 0;
+
+	return s_kernel->find(haystack.data(), haystack.size(), needle.data(), needle.size());
+}
+
+
+int str_stricmp(std::string_view s1, std::string_view s2) {
+	size_t n = s1.size() < s2.size() ? s1.size() : s2.size();
+	int ret = s_kernel->cmp(s1.data(), s2.data(), n);
+	if (ret)
+		return ret;
+	if (s1.size() == s2.size())
+		return 0;
+	return s1.size() < s2.size() ? -1 : 1;
+}
+
+
+int str_striequal(std::string_view s1, std::string_view s2) {
+	return s1.size() == s2.size() && !s_kernel->cmp(s1.data(), s2.data(), s1.size());
+}
+
+
+// lowercase str into buf (not null-terminated)
+// returns a view of the folded string, or an empty view if it does not fit
+std::string_view str_fold(std::string_view str, char* buf, size_t size) {
+	if (str.size() > size)
+		return {};
+
+	for (size_t i = 0; i < str.size(); i++)
+		buf[i] = (char)fold((unsigned char)str[i]);
+
+	return std::string_view(buf, str.size());
+}
+
+
+void str_split(std::string_view str, std::vector<std::string_view>& out, char sep) {
+	size_t f = str.find(sep);
+	while (f != std::string_view::npos) {
+		out.push_back(str.substr(0, f));
+		str.remove_prefix(f + 1);
+		f = str.find(sep);
+	}
+	if (str.size())
+		out.push_back(str);
+}
+
+
+std::vector<std::string_view> str_split(std::string_view str, char sep) {
+	std::vector<std::string_view> ret;
+	str_split(str, ret, sep);
+	return ret;
+}
+
+
+// the tokens point into buf, so they stay valid until it changes
+// used by parse_args() so each token can also be passed on as a C string
+void str_tokenize(std::string& buf, std::vector<std::string_view>& out) {
+	out.clear();
+	str_split(buf, out, ' ');
+
+	// terminate tokens in place (does not move the buffer, so the views stay valid)
+	for (auto& c : buf) {
+		if (c == ' ')
+			c = '\0';
+	}
+}
+
+
+// this is parse_args(), so say text, which has the entire text in one arg, is split into words as well
+void str_tokenize_args(const std::string* argv, size_t argc, std::string& buf, std::vector<std::string_view>& out) {
+	buf.clear();
+	for (size_t i = 0; i < argc; i++) {
+		if (i)
+			buf += ' ';
+		buf += argv[i];
+	}
+
+	str_tokenize(buf, out);
+}
+
+
+// repeated spaces don't make empty words, but "" does. an unclosed quote runs to the end
+std::vector<std::string> str_split_quoted(std::string_view str) {
+	std::vector<std::string> ret;
+	size_t i = 0;
+	while (i < str.size()) {
+		if (str[i] == ' ') {
+			i++;
+			continue;
+		}
+
+		std::string word;
+		while (i < str.size() && str[i] != ' ') {
+			if (str[i] != '"') {
+				word += str[i++];
+				continue;
+			}
+			size_t end = str.find('"', i + 1);
+			if (end == std::string_view::npos)
+				end = str.size();
+			word += str.substr(i + 1, end - i - 1);
+			i = end < str.size() ? end + 1 : end;
+		}
+		ret.push_back(std::move(word));
+	}
+	return ret;
+}
+
+
+uint32_t hash_fnv1a(const char* data, size_t size, uint32_t hash) {
+	for (size_t i = 0; i < size; i++) {
+		hash ^= (uint8_t)data[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+
+bool str_vprintf(char* buf, size_t size, const char* fmt, va_list args) {
+	if (!size)
+		return false;
+	int len = vsnprintf(buf, size, fmt, args);
+	// encoding error, leave an empty string
+	if (len < 0) {
+		buf[0] = '\0';
+		return false;
+	}
+	return (size_t)len < size;
+}
+
+
+bool str_printf(char* buf, size_t size, const char* fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+	bool ret = str_vprintf(buf, size, fmt, args);
+	va_end(args);
+	return ret;
+}
@@ -0,0 +1,217 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#define _CRT_SECURE_NO_WARNINGS 1
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "timers.h"
+
+// hierarchical timer wheel with 1ms ticks
+// level 0 has a slot per tick, each slot of level n covers all of level n-1
+// timers move down a level when the wheel reaches their slot, so adding, cancelling and
+// each tick are O(1) no matter how many timers are pending
+#define TIMER_LEVEL_BITS 6
+#define TIMER_SLOTS (1 << TIMER_LEVEL_BITS)
+#define TIMER_SLOT_MASK (TIMER_SLOTS - 1)
+#define TIMER_LEVELS 5		// 2^30ms, about 12 days (longer timers are re-filed when they get there)
+#define TIMER_MAX_DELAY ((uint64_t)1 << (TIMER_LEVEL_BITS * TIMER_LEVELS))
+
+typedef struct {
+	uint64_t when;		// tick to run at
+	pfnTimerFunc func;
+	intptr_t param;
+	uint32_t gen;		// bumped each time the node is freed, so old handles don't match
+	int slot;			// wheel slot (level * TIMER_SLOTS + index) the node is in, -1 if free
+	int prev;			// previous/next node in the slot list or freelist, -1 at the ends
+	int next;
+} timer_node;
+
+typedef struct {
+	std::vector<timer_node> nodes;
+	int heads[TIMER_LEVELS * TIMER_SLOTS];
+	int freelist;
+	uint64_t current;	// next tick to run
+	size_t count;
+	bool started;
+} timer_wheel;
+
+static timer_wheel s_wheel = {};
+
+
+// monotonic time in milliseconds
+uint64_t timer_now() {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+static void timer_start() {
+	if (s_wheel.started)
+		return;
+	for (auto& head : s_wheel.heads)
+		head = -1;
+	s_wheel.freelist = -1;
+	s_wheel.current = timer_now();
+	s_wheel.started = true;
+}
+
+
+static void timer_link(int i, int slot) {
+	timer_node& node = s_wheel.nodes[i];
+	node.slot = slot;
+	node.prev = -1;
+	node.next = s_wheel.heads[slot];
+	if (node.next >= 0)
+		s_wheel.nodes[node.next].prev = i;
+	s_wheel.heads[slot] = i;
+}
+
+
+static void timer_unlink(int i) {
+	timer_node& node = s_wheel.nodes[i];
+	if (node.prev >= 0)
+		s_wheel.nodes[node.prev].next = node.next;
+	else
+		s_wheel.heads[node.slot] = node.next;
+	if (node.next >= 0)
+		s_wheel.nodes[node.next].prev = node.prev;
+	node.slot = -1;
+}
+
+
+// put a node in the slot for its time, relative to the current tick
+static void timer_insert(int i) {
+	uint64_t when = s_wheel.nodes[i].when;
+	uint64_t current = s_wheel.current;
+
+	// already due, run on the current tick
+	if (when < current)
+		when = current;
+	// too far out, park it in the farthest slot until the wheel gets there
+	if (when - current >= TIMER_MAX_DELAY)
+		when = current + TIMER_MAX_DELAY - 1;
+
+	uint64_t delta = when - current;
+	int level = 0;
+	while (level < TIMER_LEVELS - 1 && delta >= ((uint64_t)1 << (TIMER_LEVEL_BITS * (level + 1))))
+		level++;
+
+	int index = (int)((when >> (TIMER_LEVEL_BITS * level)) & TIMER_SLOT_MASK);
+	timer_link(i, level * TIMER_SLOTS + index);
+}
+
+
+static void timer_free(int i) {
+	timer_node& node = s_wheel.nodes[i];
+	node.gen++;
+	node.func = nullptr;
+	node.next = s_wheel.freelist;
+	s_wheel.freelist = i;
+	s_wheel.count--;
+}
+
+
+// move the timers in the current slot of a level down into lower levels
+static void timer_cascade(int level) {
+	int index = (int)((s_wheel.current >> (TIMER_LEVEL_BITS * level)) & TIMER_SLOT_MASK);
+	// the next level wraps at the same time
+	if (!index && level + 1 < TIMER_LEVELS)
+		timer_cascade(level + 1);
+
+	int slot = level * TIMER_SLOTS + index;
+	int i = s_wheel.heads[slot];
+	s_wheel.heads[slot] = -1;
+	while (i >= 0) {
+		int next = s_wheel.nodes[i].next;
+		timer_insert(i);
+		i = next;
+	}
+}
+
+
+// schedule func(param) to be called after delayms milliseconds (on the first frame after that)
+timer_handle timer_add(uint64_t delayms, pfnTimerFunc func, intptr_t param) {
+	timer_start();
+
+	int i = s_wheel.freelist;
+	if (i >= 0)
+		s_wheel.freelist = s_wheel.nodes[i].next;
+	else {
+		i = (int)s_wheel.nodes.size();
+		s_wheel.nodes.push_back({});
+	}
+
+	timer_node& node = s_wheel.nodes[i];
+	// at least 1ms, so a timer added by a timer function doesn't run in the same tick
+	node.when = timer_now() + (delayms ? delayms : 1);
+	node.func = func;
+	node.param = param;
+	timer_insert(i);
+	s_wheel.count++;
+
+	return ((timer_handle)node.gen << 32) | (uint32_t)(i + 1);
+}
+
+
+// cancel a timer that hasn't run yet, returns false if it already ran or was cancelled
+bool timer_cancel(timer_handle handle) {
+	if (!handle || !s_wheel.started)
+		return false;
+
+	size_t i = (size_t)(uint32_t)handle - 1;
+	if (i >= s_wheel.nodes.size())
+		return false;
+	timer_node& node = s_wheel.nodes[i];
+	if (node.gen != (uint32_t)(handle >> 32) || node.slot < 0)
+		return false;
+
+	timer_unlink((int)i);
+	timer_free((int)i);
+	return true;
+}
+
+
+// run every tick up to now, called every frame
+void timer_frame() {
+	timer_start();
+
+	uint64_t now = timer_now();
+	// nothing to run, don't bother stepping through the ticks
+	if (!s_wheel.count) {
+		s_wheel.current = now + 1;
+		return;
+	}
+
+	while (s_wheel.current <= now) {
+		int index = (int)(s_wheel.current & TIMER_SLOT_MASK);
+		if (!index)
+			timer_cascade(1);
+
+		// pop one at a time, since a timer function can add or cancel timers
+		int i;
+		while ((i = s_wheel.heads[index]) >= 0) {
+			pfnTimerFunc func = s_wheel.nodes[i].func;
+			intptr_t param = s_wheel.nodes[i].param;
+			timer_unlink(i);
+			timer_free(i);
+			func(param);
+		}
+
+		s_wheel.current++;
+	}
+}
+
+
+// number of timers waiting to run
+size_t timer_count() {
+	return s_wheel.count;
+}
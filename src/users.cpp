@@ -0,0 +1,110 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#define _CRT_SECURE_NO_WARNINGS 1
+
+#include <qmmapi.h>
+
+#include "version.h"
+#include "game.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "main.h"
+#include "users.h"
+#include "util.h"
+
+user_store g_users;
+
+
+bool user_db::load(const char* file) {
+	clear();
+
+	// doesn't exist
+	if (!fs_read_file(file, buf))
+		return false;
+
+	const char* error = parse();
+	if (error) {
+		QMM_WRITEQMMLOG(QMMLOG_WARNING, "Unable to load user database \"%s\": %s\n", file, error);
+		clear();
+		return false;
+	}
+	return true;
+}
+
+
+bool user_store::save(const char* file) const {
+	std::vector<char> out;
+	size_t skipped = serialize(out);
+	if (skipped)
+		QMM_WRITEQMMLOG(QMMLOG_WARNING, "Skipped %zu user entries too long for the user database\n", skipped);
+
+	return fs_write_file(file, out.data(), out.size());
+}
+
+
+// compare two user stores, logging each difference at debug level
+user_diff users_diff(const user_store& from, const user_store& to) {
+	static const char* typenames[] = { "", "ip", "name", "id" };
+	user_diff diff = {};
+
+	to.for_each([&](addusertype type, std::string_view key, const user_match& match) {
+		user_match old;
+		if (!from.find_key(type, key, old)) {
+			diff.added++;
+			QMM_WRITEQMMLOG(QMMLOG_DEBUG, "Added user %s entry \"%.*s\" (access %d)\n", typenames[type], (int)key.size(), key.data(), match.access);
+		}
+		else if (old.pass != match.pass || old.access != match.access) {
+			diff.changed++;
+			QMM_WRITEQMMLOG(QMMLOG_DEBUG, "Changed user %s entry \"%.*s\" (access %d -> %d)\n", typenames[type], (int)key.size(), key.data(), old.access, match.access);
+		}
+	});
+	from.for_each([&](addusertype type, std::string_view key, const user_match&) {
+		user_match now;
+		if (!to.find_key(type, key, now)) {
+			diff.removed++;
+			QMM_WRITEQMMLOG(QMMLOG_DEBUG, "Removed user %s entry \"%.*s\"\n", typenames[type], (int)key.size(), key.data());
+		}
+	});
+
+	return diff;
+}
+
+
+// if the client's ip or guid has a user entry with the auto-auth password, give them its access
+// called when a client's ip or guid changes, with admin_auto_auth enabled
+bool player_auto_auth(intptr_t clientnum) {
+	player_info* info = g_playerinfo.find(clientnum);
+	if (!info || info->authed)
+		return false;
+
+	user_match login = {};
+	bool found = false;
+	user_match match;
+	if (info->ipvalid && g_users.find(au_ip, info->ip, match) && match.pass == USER_AUTO_PASS) {
+		login = match;
+		found = true;
+	}
+	if (g_users.find(au_id, info->guid, match) && match.pass == USER_AUTO_PASS && (!found || match.order < login.order)) {
+		login = match;
+		found = true;
+	}
+	if (!found)
+		return false;
+
+	info->access = login.access;
+	info->authed = true;
+	g_counters.autoauths++;
+	player_clientprintf(clientnum, "[QADMIN] You have been automatically authenticated. You now have %d access.\n", info->access);
+	return true;
+}
@@ -0,0 +1,231 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#define _CRT_SECURE_NO_WARNINGS 1
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "main.h"
+#include "ip.h"
+#include "str.h"
+#include "users.h"
+
+static_assert(sizeof(userdb_header) == 20, "userdb_header must match the file layout");
+static_assert(sizeof(userdb_record) == 20, "userdb_record must match the file layout");
+
+
+// build the index key for a user entry
+// ips are normalized the same way as player ips so different spellings of an address match
+std::string user_key(addusertype type, std::string_view user) {
+	ip_addr addr;
+	if (type == au_ip && ip_parse(user, addr))
+		return ip_to_str(addr);
+
+	std::string key(user.size(), '\0');
+	str_fold(user, key.data(), key.size());
+	return key;
+}
+
+
+// sort order of database records: by type, then by user
+static bool userdb_less(uint8_t atype, std::string_view auser, uint8_t btype, std::string_view buser) {
+	if (atype != btype)
+		return atype < btype;
+	return auser < buser;
+}
+
+
+// check the file data in buf, and point records and strings into it if valid
+const char* user_db::parse() {
+	if (buf.size() < sizeof(userdb_header))
+		return "too small";
+
+	const userdb_header* header = (const userdb_header*)buf.data();
+	const char* error = nullptr;
+	if (memcmp(header->magic, USERDB_MAGIC, sizeof(header->magic)))
+		error = "bad magic";
+	else if (header->version != USERDB_VERSION)
+		error = "unsupported version";
+	else if ((uint64_t)header->count * sizeof(userdb_record) + header->strsize != buf.size() - sizeof(userdb_header))
+		error = "bad size";
+	else if (header->checksum != hash_fnv1a(buf.data() + sizeof(userdb_header), buf.size() - sizeof(userdb_header)))
+		error = "bad checksum";
+
+	const userdb_record* recs = (const userdb_record*)(buf.data() + sizeof(userdb_header));
+	const char* strs = (const char*)(recs + (error ? 0 : header->count));
+	for (size_t i = 0; !error && i < header->count; i++) {
+		const userdb_record& rec = recs[i];
+		if (rec.type < au_ip || rec.type > au_id || (uint64_t)rec.user + rec.userlen > header->strsize || (uint64_t)rec.pass + rec.passlen > header->strsize)
+			error = "bad record";
+		// records must be strictly sorted for the binary search
+		else if (i && !userdb_less(recs[i - 1].type, std::string_view(strs + recs[i - 1].user, recs[i - 1].userlen), rec.type, std::string_view(strs + rec.user, rec.userlen)))
+			error = "records not sorted";
+	}
+
+	if (error)
+		return error;
+
+	records = recs;
+	strings = strs;
+	count = header->count;
+	return nullptr;
+}
+
+
+bool user_db::find(addusertype type, std::string_view key, user_match& match) const {
+	const userdb_record* end = records + count;
+	const userdb_record* it = std::lower_bound(records, end, key, [this, type](const userdb_record& rec, std::string_view key) {
+		return userdb_less(rec.type, std::string_view(strings + rec.user, rec.userlen), (uint8_t)type, key);
+	});
+	if (it == end || it->type != type || std::string_view(strings + it->user, it->userlen) != key)
+		return false;
+
+	match.pass = std::string_view(strings + it->pass, it->passlen);
+	match.access = it->access;
+	match.order = it->order;
+	return true;
+}
+
+
+void user_db::clear() {
+	buf.clear();
+	buf.shrink_to_fit();
+	records = nullptr;
+	strings = nullptr;
+	count = 0;
+}
+
+
+bool user_store::add(const user_info& info) {
+	if (info.type < au_ip || info.type > au_id)
+		return false;
+
+	std::string key = user_key(info.type, info.user);
+
+	// entries added after the database was loaded come after all of its entries,
+	// unless they replace a database record, then they take its place
+	user_info entry = info;
+	user_match match;
+	bool replaces = db.find(info.type, key, match);
+	entry.order = replaces ? match.order : db.count + count;
+	if (!index[info.type - 1].emplace(std::move(key), entry).second)
+		return false;
+
+	count++;
+	if (replaces)
+		overrides++;
+	return true;
+}
+
+
+bool user_store::find(addusertype type, std::string_view user, user_match& match) const {
+	if (type < au_ip || type > au_id || user.empty())
+		return false;
+
+	return find_key(type, user_key(type, user), match);
+}
+
+
+bool user_store::find_key(addusertype type, std::string_view key, user_match& match) const {
+	if (type < au_ip || type > au_id)
+		return false;
+
+	// admin_adduser_* entries replace database records
+	auto& map = index[type - 1];
+	auto it = map.find(std::string(key));
+	if (it == map.end())
+		return db.find(type, key, match);
+
+	match.pass = it->second.pass;
+	match.access = it->second.access;
+	match.order = it->second.order;
+	return true;
+}
+
+
+// returns the number of entries left out for being too long
+size_t user_store::serialize(std::vector<char>& out) const {
+	typedef struct {
+		uint8_t type;
+		std::string_view user;
+		std::string_view pass;
+		int access;
+		size_t order;
+	} entry;
+
+	std::vector<entry> entries;
+	entries.reserve(size());
+	size_t skipped = 0;
+	for_each([&](addusertype type, std::string_view user, const user_match& match) {
+		if (user.size() > UINT8_MAX || match.pass.size() > UINT8_MAX) {
+			skipped++;
+			return;
+		}
+		entries.push_back({ (uint8_t)type, user, match.pass, match.access, match.order });
+	});
+
+	// renumber entries by their current order, then sort for lookup
+	std::sort(entries.begin(), entries.end(), [](const entry& a, const entry& b) { return a.order < b.order; });
+	for (size_t i = 0; i < entries.size(); i++)
+		entries[i].order = i;
+	std::sort(entries.begin(), entries.end(), [](const entry& a, const entry& b) { return userdb_less(a.type, a.user, b.type, b.user); });
+
+	std::vector<userdb_record> recs;
+	std::string strs;
+	recs.reserve(entries.size());
+	for (auto& e : entries) {
+		userdb_record rec = { e.type, (uint8_t)e.user.size(), (uint8_t)e.pass.size(), 0, e.access, (uint32_t)strs.size(), 0, (uint32_t)e.order };
+		strs += e.user;
+		rec.pass = (uint32_t)strs.size();
+		strs += e.pass;
+		recs.push_back(rec);
+	}
+
+	out.assign(sizeof(userdb_header) + recs.size() * sizeof(userdb_record) + strs.size(), 0);
+	userdb_header header;
+	memcpy(header.magic, USERDB_MAGIC, sizeof(header.magic));
+	header.version = USERDB_VERSION;
+	header.count = (uint32_t)recs.size();
+	header.strsize = (uint32_t)strs.size();
+	if (!recs.empty())
+		memcpy(out.data() + sizeof(header), recs.data(), recs.size() * sizeof(userdb_record));
+	if (!strs.empty())
+		memcpy(out.data() + sizeof(header) + recs.size() * sizeof(userdb_record), strs.data(), strs.size());
+	header.checksum = hash_fnv1a(out.data() + sizeof(header), out.size() - sizeof(header));
+	memcpy(out.data(), &header, sizeof(header));
+
+	return skipped;
+}
+
+
+void user_store::swap(user_store& other) {
+	// swapping the buffer keeps its data pointer, so records/strings stay valid
+	std::swap(db.buf, other.db.buf);
+	std::swap(db.records, other.db.records);
+	std::swap(db.strings, other.db.strings);
+	std::swap(db.count, other.db.count);
+	for (size_t i = 0; i < 3; i++)
+		std::swap(index[i], other.index[i]);
+	std::swap(count, other.count);
+	std::swap(overrides, other.overrides);
+}
+
+
+void user_store::clear() {
+	db.clear();
+	for (auto& map : index)
+		map.clear();
+	count = 0;
+	overrides = 0;
+}
@@ -19,7 +19,13 @@ Created By:
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <cstdio>
+#include <cstdarg>
+#include <unordered_map>
 #include "main.h"
+#include "cvars.h"
+#include "ip.h"
+#include "timers.h"
 #include "util.h"
 
 
@@ -27,40 +33,196 @@ bool player_has_access(intptr_t clientnum, int reqaccess) {
 	if (clientnum == SERVER_CONSOLE)
 		return true;
 	
-	if (!g_playerinfo.count(clientnum))
+	player_info* info = g_playerinfo.find(clientnum);
+	if (!info)
 		return false;
 
-	int defaccess = (int)QMM_GETINTCVAR("admin_default_access");
-
-	int access = g_playerinfo[clientnum].access | defaccess;
+	int access = info->access | g_admin_default_access.integer;
 
 	return (access & reqaccess) == reqaccess;
 }
 
 
+#define OUTPUT_CHUNK (MAX_STRING_LENGTH - 16)	// most text sent in one print command
+#define OUTPUT_QUEUE_MAX 65536					// most text queued for a client, the rest is dropped
+
+// print output queued for each client, sent by player_flush_output() each frame
+static std::string s_output[QADMIN_MAX_CLIENTS];
+static client_set s_output_pending;
+
+
+static void player_send_print(intptr_t clientnum, const char* msg, size_t len) {
+#ifdef GAME_NO_SEND_SERVER_COMMAND
+	g_syscall(G_CPRINTF, clientnum, PRINT_HIGH, "%.*s", (int)len, msg);
+#else
+	char cmd[MAX_STRING_LENGTH];
+	snprintf(cmd, sizeof(cmd), "print \"%.*s\"", (int)len, msg);
+	g_syscall(G_SEND_SERVER_COMMAND, clientnum, cmd);
+#endif
+}
+
+
+// send up to budget bytes of a client's queued output (at least one command)
+static void player_send_output(intptr_t clientnum, size_t budget) {
+	std::string& out = s_output[clientnum];
+	size_t sent = 0;
+	while (sent < out.size() && sent < budget) {
+		size_t len = out.size() - sent;
+		if (len > OUTPUT_CHUNK) {
+			// end the command at a line break if there is one
+			size_t nl = out.rfind('\n', sent + OUTPUT_CHUNK - 1);
+			len = (nl != std::string::npos && nl >= sent) ? nl + 1 - sent : OUTPUT_CHUNK;
+		}
+		player_send_print(clientnum, out.data() + sent, len);
+		g_counters.output_cmds++;
+		sent += len;
+	}
+
+	out.erase(0, sent);
+	if (out.empty())
+		s_output_pending.reset(clientnum);
+}
+
+
+// prints to a client are queued and sent in as few commands as possible at the next frame
+// chat messages and prints to the console or everyone are sent immediately, after anything
+// already queued for the client so messages arrive in order
 void player_clientprint(intptr_t clientnum, const char* msg, bool chat) {
 	if (clientnum == SERVER_CONSOLE) {
 		g_syscall(G_PRINT, msg);
 		return;
 	}
-#ifdef GAME_NO_SEND_SERVER_COMMAND
 	if (clientnum == -1) {
-		for (auto& p : g_playerinfo) {
-			g_syscall(G_CPRINTF, p.first, PRINT_HIGH, "%s", msg);
+		player_broadcast(g_playerinfo.connected, msg, chat);
+		return;
+	}
+	if (!chat && client_set::valid(clientnum)) {
+		std::string& out = s_output[clientnum];
+		if (out.size() < OUTPUT_QUEUE_MAX) {
+			out += msg;
+			s_output_pending.set(clientnum);
+			g_counters.output_prints++;
 		}
 		return;
 	}
+	if (s_output_pending.test(clientnum))
+		player_send_output(clientnum, (size_t)-1);
+#ifdef GAME_NO_SEND_SERVER_COMMAND
 	g_syscall(G_CPRINTF, clientnum, PRINT_HIGH, "%s", msg);
 #else
-	if (chat)
-		g_syscall(G_SEND_SERVER_COMMAND, clientnum, QMM_VARARGS("chat \"%s\"", msg));
-	else
-		g_syscall(G_SEND_SERVER_COMMAND, clientnum, QMM_VARARGS("print \"%s\"", msg));
+	str_buf<MAX_STRING_LENGTH> cmd;
+	cmd.printf(chat ? "chat \"%s\"" : "print \"%s\"", msg);
+	g_syscall(G_SEND_SERVER_COMMAND, clientnum, cmd.c_str());
 #endif
 }
 
 
+// format a message into a stack buffer and pass it to player_clientprint()
+static void player_vprintf(intptr_t clientnum, bool chat, const char* fmt, va_list args) {
+	char msg[MAX_STRING_LENGTH];
+	if (!str_vprintf(msg, sizeof(msg), fmt, args))
+		QMM_WRITEQMMLOG(QMMLOG_DEBUG, "Message to client %d truncated: %s\n", (int)clientnum, msg);
+	player_clientprint(clientnum, msg, chat);
+}
+
+
+void player_clientprintf(intptr_t clientnum, const char* fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+	player_vprintf(clientnum, false, fmt, args);
+	va_end(args);
+}
+
+
+void player_chatprintf(intptr_t clientnum, const char* fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+	player_vprintf(clientnum, true, fmt, args);
+	va_end(args);
+}
+
+
+// append a formatted command to the server's command buffer
+void server_command(const char* fmt, ...) {
+	char cmd[MAX_STRING_LENGTH];
+	va_list args;
+	va_start(args, fmt);
+	bool fit = str_vprintf(cmd, sizeof(cmd), fmt, args);
+	va_end(args);
+
+	// don't run a cut-off command
+	if (!fit) {
+		QMM_WRITEQMMLOG(QMMLOG_WARNING, "Server command too long, not sent: %s\n", cmd);
+		return;
+	}
+	g_syscall(G_SEND_CONSOLE_COMMAND, EXEC_APPEND, cmd);
+}
+
+
+// send queued output, up to admin_output_budget bytes per client (at least one command, 0 for no limit)
+// called each frame
+void player_flush_output() {
+	if (s_output_pending.empty())
+		return;
+
+	size_t budget = g_admin_output_budget.integer > 0 ? (size_t)g_admin_output_budget.integer : (size_t)-1;
+	for (intptr_t clientnum : s_output_pending)
+		player_send_output(clientnum, budget);
+}
+
+
+// send everything queued for a set of clients now, ahead of a message sent to them directly
+void player_flush_output(const client_set& recipients) {
+	if (s_output_pending.empty())
+		return;
+	for (intptr_t playernum : recipients) {
+		if (s_output_pending.test(playernum))
+			player_send_output(playernum, (size_t)-1);
+	}
+}
+
+
+// command string reused by player_broadcast(), so sending does not allocate once it has grown
+static std::string s_broadcast;
+
+// send a message to a set of clients, building the server command only once
+void player_broadcast(const client_set& recipients, const char* msg, bool chat) {
+	player_flush_output(recipients);
+
+#ifdef GAME_NO_SEND_SERVER_COMMAND
+	for (intptr_t playernum : recipients)
+		g_syscall(G_CPRINTF, playernum, PRINT_HIGH, "%s", msg);
+#else
+	s_broadcast = chat ? "chat \"" : "print \"";
+	s_broadcast += msg;
+	s_broadcast += '"';
+
+	// everyone, let the engine send it
+	if (recipients == g_playerinfo.connected) {
+		g_syscall(G_SEND_SERVER_COMMAND, -1, s_broadcast.c_str());
+		return;
+	}
+	for (intptr_t playernum : recipients)
+		g_syscall(G_SEND_SERVER_COMMAND, playernum, s_broadcast.c_str());
+#endif
+}
+
+
+// connected clients that have all the given access
+client_set players_with_access(int reqaccess) {
+	client_set ret;
+	for (intptr_t playernum : g_playerinfo) {
+		if (player_has_access(playernum, reqaccess))
+			ret.set(playernum);
+	}
+	return ret;
+}
+
+
 void player_kick(intptr_t clientnum, std::string message) {
+	// dropping the client clears its queued output, so send it first (e.g. a ban reason printed just before)
+	if (client_set::valid(clientnum) && s_output_pending.test(clientnum))
+		player_send_output(clientnum, (size_t)-1);
 	g_syscall(G_DROP_CLIENT, clientnum, message.c_str());
 }
 
@@ -85,18 +247,19 @@ std::string strip_codes(std::string name) {
 
 
 // returns vector of indexes of partial or full matching name
-std::vector<intptr_t> players_with_name(std::string find) {
+std::vector<intptr_t> players_with_name(std::string_view find) {
 	std::vector<intptr_t> ret;
 
-	for (auto& playerinfo : g_playerinfo) {
+	for (intptr_t playernum : g_playerinfo) {
+		player_info& info = g_playerinfo[playernum];
 		// for exact match, return just this player
-		if (str_striequal(playerinfo.second.name, find) || str_striequal(playerinfo.second.stripname, find)) {
+		if (str_striequal(info.name, find) || str_striequal(info.stripname, find)) {
 			ret.clear();
-			ret.push_back(playerinfo.first);
+			ret.push_back(playernum);
 			return ret;
 		}
-		else if (str_stristr(playerinfo.second.name, find) || str_stristr(playerinfo.second.stripname, find)) {
-			ret.push_back(playerinfo.first);
+		else if (str_stristr(info.name, find) || str_stristr(info.stripname, find)) {
+			ret.push_back(playernum);
 		}
 	}
 
@@ -104,41 +267,135 @@ std::vector<intptr_t> players_with_name(std::string find) {
 }
 
 
-// returns vector of indexes with matching ip
-std::vector<intptr_t> players_with_ip(std::string find) {
+// binary ip -> connected clients using it
+static std::unordered_map<ip_addr, client_set, ip_addr_hash> s_ipindex;
+
+
+static void ip_index_remove(intptr_t clientnum) {
+	player_info& info = g_playerinfo[clientnum];
+	if (!info.ipvalid)
+		return;
+
+	auto it = s_ipindex.find(info.ipaddr);
+	if (it == s_ipindex.end())
+		return;
+	it->second.reset(clientnum);
+	if (it->second.empty())
+		s_ipindex.erase(it);
+}
+
+
+// store a client's ip (from userinfo, port is removed) and update the ip index
+void player_set_ip(intptr_t clientnum, std::string_view ip) {
+	player_info& info = g_playerinfo[clientnum];
+
+	ip_index_remove(clientnum);
+
+	info.ipvalid = ip_parse(ip, info.ipaddr);
+	if (info.ipvalid) {
+		info.ip = ip_to_str(info.ipaddr);
+		s_ipindex[info.ipaddr].set(clientnum);
+	}
+	// not an address (i.e. "localhost" or "bot"), just strip anything after a colon
+	else {
+		info.ip = ip.substr(0, ip.find(':'));
+	}
+}
+
+
+// clean up after a client disconnects
+void player_disconnect(intptr_t clientnum) {
+	if (!g_playerinfo.has(clientnum))
+		return;
+
+	ip_index_remove(clientnum);
+	timer_cancel(g_playerinfo[clientnum].gagtimer);
+	g_playerinfo.remove(clientnum);
+
+	// drop any output still queued
+	if (client_set::valid(clientnum)) {
+		s_output[clientnum].clear();
+		s_output_pending.reset(clientnum);
+	}
+}
+
+
+// returns vector of indexes with matching ip or ip range ("1.2.3.0/24")
+std::vector<intptr_t> players_with_ip(std::string_view find) {
 	std::vector<intptr_t> ret;
 
-	for (auto& playerinfo : g_playerinfo) {
-		if (playerinfo.second.ip == find)
-			ret.push_back(playerinfo.first);
+	ip_addr net;
+	int prefixlen;
+	// not an address, compare as text
+	if (!ip_parse_cidr(find, net, prefixlen)) {
+		for (intptr_t playernum : g_playerinfo) {
+			if (g_playerinfo[playernum].ip == find)
+				ret.push_back(playernum);
+		}
+		return ret;
+	}
+
+	client_set found;
+	// single address, just look it up
+	if (prefixlen == 128) {
+		auto it = s_ipindex.find(net);
+		if (it != s_ipindex.end())
+			found = it->second;
 	}
+	// range, check each distinct address in use
+	else {
+		for (auto& entry : s_ipindex) {
+			if (ip_match(entry.first, net, prefixlen)) {
+				for (intptr_t playernum : entry.second)
+					found.set(playernum);
+			}
+		}
+	}
+
+	for (intptr_t playernum : found)
+		ret.push_back(playernum);
 
 	return ret;
 }
 
 
-bool is_valid_map(std::string map) {
-// games that don't have readability into pak/pk3 files, just return true
-#ifdef GAME_MOHAA
+// read an entire file through the engine filesystem
+// returns false if it doesn't exist or the game has no filesystem access
+bool fs_read_file(const char* file, std::vector<char>& out) {
+	out.clear();
+	if (G_FS_FOPEN_FILE < 0 || !file || !*file)
+		return false;
+
+	fileHandle_t f;
+	intptr_t size = (int)g_syscall(G_FS_FOPEN_FILE, file, &f, FS_READ);
+	if (size < 0)
+		return false;
+
+	out.resize((size_t)size);
+	if (size)
+		g_syscall(G_FS_READ, out.data(), (int)size, f);
+	g_syscall(G_FS_FCLOSE_FILE, f);
 	return true;
-#else
-	if (G_FS_FOPEN_FILE < 0)
-		return true;
-#endif
+}
 
-	fileHandle_t fmap;
 
-	intptr_t mapsize = (int)g_syscall(G_FS_FOPEN_FILE, QMM_VARARGS("maps/%s.bsp", map.c_str()), &fmap, FS_READ);
-	// doesn't exist, return immediately
-	if (mapsize < 0)
+// write an entire file through the engine filesystem
+bool fs_write_file(const char* file, const char* data, size_t size) {
+	if (G_FS_FOPEN_FILE < 0 || !file || !*file)
 		return false;
-	// if file was 0 bytes, we still need to close, but return false
-	g_syscall(G_FS_FCLOSE_FILE, fmap);
-	return mapsize ? true : false;
+
+	fileHandle_t f = 0;
+	if (g_syscall(G_FS_FOPEN_FILE, file, &f, FS_WRITE) < 0 || !f)
+		return false;
+	if (size)
+		g_syscall(G_FS_WRITE, data, (int)size, f);
+	g_syscall(G_FS_FCLOSE_FILE, f);
+	return true;
 }
 
 
-std::string str_sanitize(std::string str) {
+std::string str_sanitize(std::string_view view) {
+	std::string str(view);
 	size_t sep = str.find_first_of("\";\\");
 	while (sep != std::string::npos) {
 		str[sep] = ' ';
@@ -148,67 +405,91 @@ std::string str_sanitize(std::string str) {
 }
 
 
-int str_stristr(std::string haystack, std::string needle) {
-	for (auto& c : haystack)
-		c = (char)std::tolower((unsigned char)c);
-	for (auto& c : needle)
-		c = (char)std::tolower((unsigned char)c);
+// scan an info string ("\key\value\key\value") once to find the values for several keys (at most 32)
+// keys are case-insensitive and the first occurrence wins. values are views into info (empty if missing)
+void info_scan(std::string_view info, const char* const* keys, std::string_view* values, size_t count) {
+	uint32_t missing = count >= 32 ? ~0u : (1u << count) - 1;	// bit set for each key not found yet
+	for (size_t i = 0; i < count; i++)
+		values[i] = {};
 
-	return haystack.find(needle) != std::string::npos;
-}
+	if (!info.empty() && info[0] == '\\')
+		info.remove_prefix(1);
 
+	while (!info.empty() && missing) {
+		size_t sep = info.find('\\');
+		std::string_view key = info.substr(0, sep);
+		std::string_view value;
+		if (sep == std::string_view::npos) {
+			info = {};
+		}
+		else {
+			info.remove_prefix(sep + 1);
+			sep = info.find('\\');
+			value = info.substr(0, sep);
+			info.remove_prefix(sep == std::string_view::npos ? info.size() : sep + 1);
+		}
 
-int str_stricmp(std::string s1, std::string s2) {
-	for (auto& c : s1)
-		c = (char)std::tolower((unsigned char)c);
-	for (auto& c : s2)
-		c = (char)std::tolower((unsigned char)c);
-
-	return s1.compare(s2);
+		for (size_t i = 0; i < count && i < 32; i++) {
+			if ((missing & (1u << i)) && str_striequal(key, keys[i])) {
+				values[i] = value;
+				missing &= ~(1u << i);
+				break;
+			}
+		}
+	}
 }
 
 
-int str_striequal(std::string s1, std::string s2) {
-	return str_stricmp(s1, s2) == 0;
-}
+// buffers and token list reused by parse_args(), so parsing a command does not allocate once these have grown
+// s_argv only grows, so its strings keep their capacity
+static std::vector<std::string> s_argv;
+static std::string s_argbuf;
+static std::vector<std::string_view> s_args;
 
+// append all args to a single string, separated by spaces, then split it on spaces (see str_tokenize_args())
+// this is done so say commands which have the entire text in arg1 will still parse correctly
+// each token is null-terminated in place, so args[i].data() can be used as a C string
+// the returned views are only valid until the next call
+const std::vector<std::string_view>& parse_args(int start) {
+	int argc = (int)g_syscall(G_ARGC);
+	size_t count = argc > start ? (size_t)(argc - start) : 0;
+	if (s_argv.size() < count)
+		s_argv.resize(count);
 
-std::vector<std::string> parse_str(std::string str, char sep) {
-	std::vector<std::string> ret;
-	
-	size_t f = str.find(sep);
-	while (f != std::string::npos) {
-		ret.push_back(str.substr(0, f));
-		str = str.substr(f + 1);
-		f = str.find(sep);
+	char temp[MAX_STRING_LENGTH];
+	for (size_t i = 0; i < count; i++) {
+		QMM_ARGV(start + (int)i, temp, sizeof(temp));
+		s_argv[i] = temp;
 	}
-	if (str.size())
-		ret.push_back(str);
 
-	return ret;
+	str_tokenize_args(s_argv.data(), count, s_argbuf, s_args);
+	return s_args;
 }
 
 
-// append all args to a single string, separated by spaces
-// this is done so say commands which have the entire text in arg1 will still parse correctly
-std::vector<std::string> parse_args(int start) {
-	int end = (int)g_syscall(G_ARGC) - 1;
+// the engine's arguments after cmd, as the engine split them (so quoted arguments are still whole)
+// empty if cmd is not one of the arguments
+std::vector<std::string> parse_argv_after(std::string_view cmd) {
+	std::vector<std::string> ret;
+	int argc = (int)g_syscall(G_ARGC);
 
 	char temp[MAX_STRING_LENGTH];
-	std::string s;
-
-	for (int i = start; i <= end; i++) {
+	int i = 0;
+	for (; i < argc; i++) {
 		QMM_ARGV(i, temp, sizeof(temp));
-		if (i != start)
-			s += " ";
-		s += temp;
+		if (str_striequal(temp, cmd))
+			break;
+	}
+	for (i++; i < argc; i++) {
+		QMM_ARGV(i, temp, sizeof(temp));
+		ret.push_back(temp);
 	}
 
-	return parse_str(s, ' ');
+	return ret;
 }
 
 
-std::string str_join(std::vector<std::string> arr, size_t start, char delim) {
+std::string str_join(cmd_args arr, size_t start, char delim) {
 	bool first = true;
 	std::string ret;
 	for (size_t i = start; i < arr.size(); i++) {
@@ -16,70 +16,233 @@ Created By:
 #include "version.h"
 #include "game.h"
 
-#include <string.h>
+#include <string>
+#include <utility>
 #include <time.h>
 #include "main.h"
+#include "timers.h"
 #include "vote.h"
 #include "util.h"
 
-vote_info g_vote;
+vote_info g_votes[MAX_VOTES];
 
 
-// initiate a vote
-void vote_start(intptr_t clientnum, pfnVoteFunc callback, intptr_t seconds, int choices, void* param) {
-	if (g_vote.inuse) {
-		player_clientprint(clientnum, "[QADMIN] A vote is already running\n");
-		return;
+// number of votes running
+int vote_count() {
+	int count = 0;
+	for (auto& vote : g_votes) {
+		if (vote.inuse)
+			count++;
+	}
+	return count;
+}
+
+
+// command to vote in the given vote (id is only needed if several are running)
+std::string vote_cmd(int id) {
+	if (vote_count() > 1)
+		return "castvote " + std::to_string(id);
+	return "castvote";
+}
+
+
+// tell a client about all running votes
+static void vote_list(intptr_t clientnum) {
+	for (auto& vote : g_votes) {
+		if (vote.inuse)
+			player_clientprintf(clientnum, "[QADMIN] #%d: %s (%ld seconds left)\n", vote.id, vote.desc.c_str(), (long)(vote.finishtime - g_leveltime));
 	}
-	g_vote.clientnum = clientnum;
-	g_vote.votefunc = callback;
-	g_vote.finishtime = g_leveltime + seconds;
-	g_vote.choices = choices;
-	g_vote.param = param;
-	g_vote.inuse = true;
-	g_vote.votes.clear();
 }
 
 
-// someone has voted (vote should be 1-9)
-void vote_add(intptr_t clientnum, int vote) {
-	if (!g_vote.inuse) {
+// find the vote a client means, id 0 means the only one running
+static vote_info* vote_find(intptr_t clientnum, int id) {
+	if (id) {
+		if (id < 1 || id > MAX_VOTES || !g_votes[id - 1].inuse) {
+			player_clientprintf(clientnum, "[QADMIN] There is no vote #%d running\n", id);
+			return nullptr;
+		}
+		return &g_votes[id - 1];
+	}
+
+	int count = vote_count();
+	if (!count) {
 		player_clientprint(clientnum, "[QADMIN] There is no vote currently running\n");
-		return;
+		return nullptr;
+	}
+	if (count > 1) {
+		player_clientprint(clientnum, "[QADMIN] Several votes are running, choose one by number:\n");
+		vote_list(clientnum);
+		return nullptr;
+	}
+	for (auto& vote : g_votes) {
+		if (vote.inuse)
+			return &vote;
+	}
+	return nullptr;
+}
+
+
+// choice with the most votes, the lowest choice wins a tie, 0 if no one voted
+static int vote_leader(const vote_info& vote) {
+	int winner = 0;
+	int winvotes = 0;
+	for (int i = 0; i < vote.choices; i++) {
+		if (vote.counts[i] > winvotes) {
+			winner = i + 1;
+			winvotes = vote.counts[i];
+		}
+	}
+	return winner;
+}
+
+
+// check if the clients who haven't voted yet can no longer change the winner
+static bool vote_decided(const vote_info& vote) {
+	int leader = vote_leader(vote);
+	if (!leader)
+		return false;
+
+	client_set eligible = players_with_access(LEVEL_1);
+	int remaining = 0;
+	for (int w = 0; w < client_set::num_words; w++)
+		remaining += bit_count(eligible.words[w] & ~vote.voted.words[w]);
+
+	int leadvotes = vote.counts[leader - 1];
+	for (int i = 0; i < vote.choices; i++) {
+		if (i == leader - 1)
+			continue;
+		int best = vote.counts[i] + remaining;
+		if (best > leadvotes || (best == leadvotes && i < leader - 1))
+			return false;
+	}
+	return true;
+}
+
+
+// choice a client voted for, 0 if none
+static int vote_choice(const vote_info& vote, intptr_t clientnum) {
+	if (!vote.voted.test(clientnum))
+		return 0;
+	for (int i = 0; i < vote.choices; i++) {
+		if (vote.ballots[i].test(clientnum))
+			return i + 1;
+	}
+	return 0;
+}
+
+
+static void vote_timer(intptr_t id) {
+	vote_info& vote = g_votes[id - 1];
+	vote.timer = 0;
+	if (vote.inuse)
+		vote_finish(vote);
+}
+
+
+// initiate a vote, returns the vote id or 0 if none could be started
+int vote_start(intptr_t clientnum, pfnVoteFunc callback, intptr_t seconds, int choices, vote_param param, std::string desc) {
+	if (choices < 2 || choices > MAX_CHOICES) {
+		player_clientprintf(clientnum, "[QADMIN] A vote needs 2-%d options\n", MAX_CHOICES);
+		return 0;
+	}
+
+	for (int i = 0; i < MAX_VOTES; i++) {
+		vote_info& vote = g_votes[i];
+		if (vote.inuse)
+			continue;
+
+		vote = {};
+		vote.id = i + 1;
+		vote.clientnum = clientnum;
+		vote.votefunc = callback;
+		vote.finishtime = g_leveltime + seconds;
+		vote.choices = choices;
+		vote.param = std::move(param);
+		vote.desc = std::move(desc);
+		vote.timer = timer_add((uint64_t)seconds * 1000, vote_timer, vote.id);
+		vote.inuse = true;
+		return vote.id;
 	}
 
-	if (g_vote.votes.count(clientnum)) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] You have already voted for %d\n", g_vote.votes[clientnum]));
+	player_clientprint(clientnum, "[QADMIN] Too many votes are already running\n");
+	return 0;
+}
+
+
+// someone has voted (vote should be 1-choices)
+void vote_add(intptr_t clientnum, int id, int vote) {
+	vote_info* v = vote_find(clientnum, id);
+	if (!v)
+		return;
+
+	int choice = vote_choice(*v, clientnum);
+	if (choice) {
+		player_clientprintf(clientnum, "[QADMIN] You have already voted for %d\n", choice);
 		return;
 	}
 
-	if (vote < 1 || vote > g_vote.choices) {
-		player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Invalid vote option, choose from 1-%d\n", g_vote.choices));
+	if (vote < 1 || vote > v->choices) {
+		player_clientprintf(clientnum, "[QADMIN] Invalid vote option, choose from 1-%d\n", v->choices);
 		return;
 	}
 
-	g_vote.votes[clientnum] = vote;
-	player_clientprint(clientnum, QMM_VARARGS("[QADMIN] Vote counted for %d\n", vote));
+	v->ballots[vote - 1].set(clientnum);
+	v->counts[vote - 1]++;
+	v->voted.set(clientnum);
+	v->total++;
+	player_clientprintf(clientnum, "[QADMIN] Vote counted for %d\n", vote);
+
+	if (vote_decided(*v))
+		vote_finish(*v);
+}
+
+
+void vote_abort(intptr_t clientnum, int id) {
+	vote_info* v = vote_find(clientnum, id);
+	if (!v)
+		return;
+
+	player_clientprintf(-1, "[QADMIN] The vote to %s has been canceled\n", v->desc.c_str());
+	timer_cancel(v->timer);
+	*v = {};
 }
 
 
 // vote has ended
-void vote_finish() {
-	int winner = 0;					// winning choice
-	std::map<int, int> votecount;	// votecount[choice] = numvotes
+void vote_finish(vote_info& vote) {
+	// free the slot first, so the callback can see the vote is over
+	vote.inuse = false;
+	timer_cancel(vote.timer);
+
+	int winner = vote_leader(vote);
+	vote.votefunc(winner, winner ? vote.counts[winner - 1] : 0, vote.total, vote.param);
+	vote = {};
+}
 
-	// tally up the votes
-	for (auto& vote : g_vote.votes) {
-		votecount[vote.second]++;
-	}
 
-	// figure out which choice won
-	for (auto& vote : votecount) {
-		if (vote.second > votecount[winner])
-			winner = vote.first;
+// remove a disconnecting client's ballots, and cancel votes to kick them
+void vote_remove_client(intptr_t clientnum) {
+	for (auto& vote : g_votes) {
+		if (!vote.inuse)
+			continue;
+
+		int choice = vote_choice(vote, clientnum);
+		if (choice) {
+			vote.ballots[choice - 1].reset(clientnum);
+			vote.counts[choice - 1]--;
+			vote.voted.reset(clientnum);
+			vote.total--;
+		}
+
+		const vote_kick_param* kick = std::get_if<vote_kick_param>(&vote.param);
+		if (kick && kick->clientnum == clientnum) {
+			player_clientprintf(-1, "[QADMIN] The vote to %s has been canceled, player left the server\n", vote.desc.c_str());
+			timer_cancel(vote.timer);
+			vote = {};
+		}
+		// fewer clients left to vote
+		else if (vote_decided(vote))
+			vote_finish(vote);
 	}
-
-	// if the winning votecount is 0 (no one voted), then give winner as 0
-	g_vote.votefunc(winner, votecount[winner], (int)g_vote.votes.size(), g_vote.param);
-	g_vote.inuse = 0;
 }
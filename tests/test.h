@@ -0,0 +1,67 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+#ifndef QADMIN_QMM_TEST_H
+#define QADMIN_QMM_TEST_H
+
+// helpers for the standalone tests and benchmarks in tests/, built and run with "make test"
+// each test is its own program, linked only with sources that don't call the engine
+
+#include <chrono>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+
+static int s_test_failures = 0;
+
+// report a failed check, only the first few are printed
+static void test_fail(const char* fmt, ...) {
+	if (++s_test_failures > 20)
+		return;
+	va_list args;
+	va_start(args, fmt);
+	printf("FAIL: ");
+	vprintf(fmt, args);
+	printf("\n");
+	va_end(args);
+}
+
+#define TEST_CHECK(cond) do { if (!(cond)) test_fail("%s:%d: %s", __FILE__, __LINE__, #cond); } while (0)
+
+// print the result, the return value is used as the exit code
+static int test_result(const char* name) {
+	if (s_test_failures)
+		printf("%s: %d checks failed\n", name, s_test_failures);
+	else
+		printf("%s: all checks passed\n", name);
+	return s_test_failures != 0;
+}
+
+// results of benchmarked calls go here so the calls aren't optimized out
+static volatile size_t s_bench_sink;
+
+// time func(i) for i in [0, iterations) and print the average time per call
+// func returns a value that depends on its work, which is kept in s_bench_sink
+template <typename F>
+static double bench(const char* name, size_t iterations, F func) {
+	size_t sink = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < iterations; i++)
+		sink += (size_t)func(i);
+	auto end = std::chrono::steady_clock::now();
+	s_bench_sink = sink;
+
+	double ns = std::chrono::duration<double, std::nano>(end - start).count() / (double)iterations;
+	printf("  %-48s %10.1f ns\n", name, ns);
+	return ns;
+}
+
+#endif // QADMIN_QMM_TEST_H
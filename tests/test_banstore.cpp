@@ -0,0 +1,258 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+// tests the ban trie and filter against a brute-force search, and benchmarks connect checks with 100k+ bans
+
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "bans.h"
+#include "ip.h"
+#include "str.h"
+#include "test.h"
+
+static std::mt19937 s_rng(1);
+
+
+// random address, mostly IPv4-mapped, with bits concentrated near 0 so ranges overlap
+static ip_addr random_addr() {
+	ip_addr addr;
+	for (auto& b : addr.bytes)
+		b = s_rng() % 4 ? (uint8_t)(s_rng() % 2) : (uint8_t)s_rng();
+	if (s_rng() % 2) {
+		memset(addr.bytes, 0, 10);
+		addr.bytes[10] = addr.bytes[11] = 0xff;
+	}
+	return addr;
+}
+
+
+static ip_addr random_v4() {
+	ip_addr addr;
+	addr.bytes[10] = addr.bytes[11] = 0xff;
+	uint32_t v = s_rng();
+	memcpy(addr.bytes + 12, &v, sizeof(v));
+	return addr;
+}
+
+
+typedef std::map<std::pair<std::string, int>, ban_info> ban_list;	// (masked address bytes, prefix length) -> ban
+
+// longest unexpired range in the list containing addr
+static const ban_info* brute_find(const ban_list& bans, const ip_addr& addr, time_t now) {
+	const ban_info* found = nullptr;
+	int foundlen = -1;
+	for (auto& it : bans) {
+		ip_addr net;
+		memcpy(net.bytes, it.first.first.data(), sizeof(net.bytes));
+		int len = it.first.second;
+		if (len > foundlen && ip_match(addr, net, len) && (!it.second.expires || it.second.expires > now)) {
+			found = &it.second;
+			foundlen = len;
+		}
+	}
+	return found;
+}
+
+
+// random adds and removes, then lookups, compared to a plain list of ranges
+static void test_trie() {
+	for (int round = 0; round < 20; round++) {
+		ban_trie trie;
+		ban_list ref;
+		for (int i = 0; i < 2000; i++) {
+			ip_addr net = random_addr();
+			int len = (int)(s_rng() % 129);
+			ip_mask(net, len);
+			auto key = std::make_pair(std::string((const char*)net.bytes, sizeof(net.bytes)), len);
+
+			if (s_rng() % 4 == 0) {
+				bool removed = trie.remove(net, len);
+				if (removed != (ref.erase(key) != 0))
+					test_fail("round %d: remove of /%d returned %d", round, len, removed);
+			}
+			else {
+				ban_info ban = { std::to_string(i), s_rng() % 3 ? 0 : (time_t)(s_rng() % 100) };
+				trie.add(net, len, ban);
+				ref[key] = ban;
+			}
+		}
+		TEST_CHECK(trie.count == ref.size());
+
+		for (int i = 0; i < 2000; i++) {
+			ip_addr addr = random_addr();
+			time_t now = (time_t)(s_rng() % 100);
+			const ban_info* found = trie.find(addr, now);
+			const ban_info* expected = brute_find(ref, addr, now);
+			if (!found != !expected || (found && found->reason != expected->reason))
+				test_fail("round %d: find returned %s, expected %s", round, found ? found->reason.c_str() : "nothing", expected ? expected->reason.c_str() : "nothing");
+		}
+
+		size_t ranges = 0;
+		trie.for_each([&](const ip_addr&, int, const ban_info&) { ranges++; });
+		TEST_CHECK(ranges == ref.size());
+
+		// removing everything leaves an empty trie
+		for (auto& it : ref) {
+			ip_addr net;
+			memcpy(net.bytes, it.first.first.data(), sizeof(net.bytes));
+			TEST_CHECK(trie.remove(net, it.first.second));
+		}
+		TEST_CHECK(trie.count == 0 && trie.root < 0);
+	}
+}
+
+
+// the filter must never turn away a banned client, whether it was built or added to
+static void test_store() {
+	ban_store store;
+	ban_filter_build(store);
+
+	std::vector<ip_addr> banned;
+	std::vector<std::string> guids;
+	for (int i = 0; i < 5000; i++) {
+		ip_addr addr = random_v4();
+		char ip[64];
+		int len = i % 3 ? 32 : 24;
+		str_printf(ip, sizeof(ip), "%d.%d.%d.%d/%d", addr.bytes[12], addr.bytes[13], addr.bytes[14], addr.bytes[15], len);
+		TEST_CHECK(ban_store_add_ip(store, ip, { "test", 0 }));
+		banned.push_back(addr);
+
+		char guid[33];
+		str_printf(guid, sizeof(guid), "%08X%08X%08X%08X", (unsigned)s_rng(), (unsigned)s_rng(), (unsigned)s_rng(), (unsigned)i);
+		TEST_CHECK(ban_store_add_id(store, guid, { "test", 0 }));
+		guids.push_back(guid);
+	}
+	TEST_CHECK(!ban_store_add_ip(store, "not an ip", { "test", 0 }));
+	TEST_CHECK(!ban_store_add_id(store, "two words", { "test", 0 }));
+
+	for (int pass = 0; pass < 2; pass++) {
+		for (size_t i = 0; i < banned.size(); i++) {
+			// lowercase guid, the ban was added in uppercase
+			std::string guid = ban_id_key(guids[i]);
+			if (!ban_store_maybe(store, &banned[i], "") || !ban_store_find(store, &banned[i], "", 0))
+				test_fail("pass %d: banned address %zu not found", pass, i);
+			if (!ban_store_maybe(store, nullptr, guid) || !ban_store_find(store, nullptr, guid, 0))
+				test_fail("pass %d: banned guid %s not found", pass, guid.c_str());
+		}
+		// the same checks after a rebuild
+		ban_filter_build(store);
+	}
+
+	// unbanned clients mostly don't get past the filter
+	size_t passed = 0, wrong = 0;
+	const size_t clients = 100000;
+	for (size_t i = 0; i < clients; i++) {
+		ip_addr addr = random_v4();
+		bool maybe = ban_store_maybe(store, &addr, "0123456789abcdef0123456789abcdef");
+		const ban_info* ban = ban_store_find(store, &addr, "0123456789abcdef0123456789abcdef", 0);
+		passed += maybe;
+		wrong += ban && !maybe;
+	}
+	TEST_CHECK(wrong == 0);
+	printf("filter: %.2f%% of unbanned clients need a full lookup\n", passed * 100.0 / clients);
+
+	// removed bans are gone, and the rest are still found after the rebuild
+	TEST_CHECK(ban_store_remove(store, ban_id_key(guids[0])));
+	TEST_CHECK(!ban_store_remove(store, guids[0]));
+	TEST_CHECK(store.filter.dirty);
+	ban_filter_build(store);
+	TEST_CHECK(!ban_store_find(store, nullptr, guids[0], 0));
+	TEST_CHECK(ban_store_find(store, nullptr, guids[1], 0));
+
+	// expired bans don't match
+	TEST_CHECK(ban_store_add_ip(store, "192.0.2.1", { "temporary", 100 }));
+	ip_addr addr;
+	TEST_CHECK(ip_parse("192.0.2.1", addr));
+	TEST_CHECK(ban_store_find(store, &addr, "", 99));
+	TEST_CHECK(!ban_store_find(store, &addr, "", 100));
+}
+
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+// a large ban list: IPv4 addresses and ranges, IPv6 /64s and guids
+static void bench_store(size_t num) {
+	std::vector<std::string> lines;
+	for (size_t i = 0; i < num; i++) {
+		char line[64];
+		ip_addr addr = random_v4();
+		switch (i % 4) {
+		case 0:
+		case 1:
+			str_printf(line, sizeof(line), "%d.%d.%d.%d", addr.bytes[12], addr.bytes[13], addr.bytes[14], addr.bytes[15]);
+			break;
+		case 2:
+			str_printf(line, sizeof(line), "%d.%d.%d.0/%d", addr.bytes[12], addr.bytes[13], addr.bytes[14], 24);
+			break;
+		default:
+			str_printf(line, sizeof(line), "2001:db8:%x:%x::/64", (unsigned)(s_rng() & 0xffff), (unsigned)(s_rng() & 0xffff));
+			break;
+		}
+		lines.push_back(line);
+	}
+	std::vector<std::string> guids;
+	for (size_t i = 0; i < num / 2; i++) {
+		char guid[33];
+		str_printf(guid, sizeof(guid), "%08X%08X%08X%08X", (unsigned)s_rng(), (unsigned)s_rng(), (unsigned)s_rng(), (unsigned)i);
+		guids.push_back(guid);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	ban_store store;
+	ban_filter_build(store);
+	for (auto& line : lines)
+		ban_store_add_ip(store, line, { "banned", 0 });
+	for (auto& guid : guids)
+		ban_store_add_id(store, guid, { "banned", 0 });
+	ban_filter_build(store);
+	printf("  %zu ip bans, %zu guid bans: load %.1f ms, %zu trie nodes\n", store.ips.count, store.ids.size(), elapsed_ms(start), store.ips.nodes.size());
+
+	// connecting clients, almost all not banned
+	std::vector<ip_addr> clients(4096);
+	for (auto& addr : clients)
+		addr = random_v4();
+	std::vector<ip_addr> banned(4096);
+	for (auto& addr : banned) {
+		const std::string& line = lines[s_rng() % lines.size()];
+		ip_parse(line.substr(0, line.find('/')), addr);
+	}
+	const char* guid = "0123456789abcdef0123456789abcdef";
+
+	auto check = [&](const ip_addr& addr, std::string_view id) {
+		return ban_store_maybe(store, &addr, id) ? ban_store_find(store, &addr, id, 0) != nullptr : false;
+	};
+	bench("connect check, not banned", 1000000, [&](size_t i) { return check(clients[i % clients.size()], guid); });
+	bench("connect check, banned guid", 1000000, [&](size_t i) { return check(clients[i % clients.size()], guids[i % guids.size()]); });
+	bench("trie lookup only, not banned", 1000000, [&](size_t i) { return store.ips.find(clients[i % clients.size()], 0) != nullptr; });
+	bench("trie lookup only, banned ip", 1000000, [&](size_t i) { return store.ips.find(banned[i % banned.size()], 0) != nullptr; });
+}
+
+
+int main() {
+	test_trie();
+	test_store();
+
+	printf("ban store:\n");
+	bench_store(10000);
+	bench_store(100000);
+	bench_store(400000);
+
+	return test_result("test_banstore");
+}
@@ -0,0 +1,148 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+// tests and benchmarks the case-folded command lookup used by handlecommand() against the old linear search
+
+#include <cctype>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "main.h"
+#include "cmds.h"
+#include "str.h"
+#include "test.h"
+
+// command names from g_admincmds, handlers are not needed
+static std::vector<cmd_info> s_cmds;
+
+static const char* s_names[] = {
+	"admin_ban", "admin_banid", "admin_banip", "admin_cfg", "admin_chat", "admin_csay", "admin_currentmap", "admin_fraglimit",
+	"admin_friendlyfire", "admin_gag", "admin_gametype", "admin_gravity", "admin_help", "admin_hostname", "admin_kick",
+	"admin_listbans", "admin_listmaps", "admin_login", "admin_map", "admin_pass", "admin_psay", "admin_nopass", "admin_rcon",
+	"admin_reload", "admin_savedb", "admin_say", "admin_stats", "admin_tempban", "admin_timeleft", "admin_timelimit",
+	"admin_unban", "admin_ungag", "admin_userlist", "admin_vote_abort", "admin_vote_cancel", "admin_vote_custom",
+	"admin_vote_kick", "admin_vote_map", "castvote", "say",
+};
+
+// client commands that are not ours, which most commands are
+static const char* s_others[] = {
+	"team", "follow", "score", "callvote", "vote", "userinfo", "kill", "say_team", "tell", "give", "noclip", "where",
+	"levelshot", "setviewpos", "admin", "admin_", "admin_kic", "admin_kickk", "sayy", "",
+};
+
+
+// old version, from handlecommand() before the lookup index was added
+static int old_striequal(std::string s1, std::string s2) {
+	for (auto& c : s1)
+		c = (char)std::tolower((unsigned char)c);
+	for (auto& c : s2)
+		c = (char)std::tolower((unsigned char)c);
+
+	return s1.compare(s2) == 0;
+}
+
+
+static const cmd_info* old_find(const std::vector<cmd_info>& cmds, std::string cmd) {
+	for (auto& admincmd : cmds) {
+		if (old_striequal(admincmd.cmd, cmd))
+			return &admincmd;
+	}
+	return nullptr;
+}
+
+
+static void check_find(const cmd_index& index, const std::string& cmd) {
+	const cmd_info* found = cmd_index_find(index, cmd);
+	const cmd_info* expected = old_find(s_cmds, cmd);
+	if (found != expected)
+		test_fail("cmd_index_find(\"%s\") = %s, expected %s", cmd.c_str(), found ? found->cmd : "nullptr", expected ? expected->cmd : "nullptr");
+}
+
+
+static void test_lookup(const cmd_index& index) {
+	TEST_CHECK(index.map.size() == s_cmds.size());
+
+	// every command in every case
+	for (auto& cmd : s_cmds) {
+		std::string name = cmd.cmd;
+		check_find(index, name);
+		for (auto& c : name)
+			c = (char)std::toupper((unsigned char)c);
+		check_find(index, name);
+		for (size_t i = 0; i < name.size(); i += 2)
+			name[i] = (char)std::tolower((unsigned char)name[i]);
+		check_find(index, name);
+	}
+
+	for (const char* other : s_others)
+		check_find(index, other);
+
+	// too long to be a command, even if it starts with one
+	TEST_CHECK(!cmd_index_find(index, std::string(MAX_COMMAND_LENGTH + 1, 'a')));
+	TEST_CHECK(!cmd_index_find(index, "admin_kick" + std::string(MAX_COMMAND_LENGTH, ' ')));
+
+	// random edits of command names
+	std::mt19937 rng(1);
+	for (int i = 0; i < 100000; i++) {
+		std::string name = s_cmds[rng() % s_cmds.size()].cmd;
+		switch (rng() % 4) {
+		case 0:
+			name[rng() % name.size()] ^= 0x20;
+			break;
+		case 1:
+			name.erase(rng() % name.size(), 1);
+			break;
+		case 2:
+			name.insert(rng() % (name.size() + 1), 1, "aZ_ \xc1"[rng() % 5]);
+			break;
+		default:
+			break;
+		}
+		check_find(index, name);
+	}
+}
+
+
+static void bench_lookup(const cmd_index& index) {
+	std::vector<std::string> hits, misses;
+	for (auto& cmd : s_cmds) {
+		hits.push_back(cmd.cmd);
+		hits.back()[0] = (char)std::toupper((unsigned char)hits.back()[0]);
+	}
+	for (const char* other : s_others)
+		misses.push_back(other);
+	const size_t iterations = 1000000;
+
+	printf("command lookup (%zu commands):\n", s_cmds.size());
+	bench("cmd_index_find (hit)", iterations, [&](size_t i) { return cmd_index_find(index, hits[i % hits.size()]) != nullptr; });
+	bench("old linear search (hit)", iterations, [&](size_t i) { return old_find(s_cmds, hits[i % hits.size()]) != nullptr; });
+	bench("cmd_index_find (not a qadmin command)", iterations, [&](size_t i) { return cmd_index_find(index, misses[i % misses.size()]) != nullptr; });
+	bench("old linear search (not a qadmin command)", iterations, [&](size_t i) { return old_find(s_cmds, misses[i % misses.size()]) != nullptr; });
+}
+
+
+int main() {
+	for (const char* name : s_names)
+		s_cmds.push_back({ name, nullptr, 0, 0, nullptr, nullptr, {} });
+
+	cmd_index index;
+	cmd_index_build(index, s_cmds);
+	test_lookup(index);
+
+	// rebuilding reuses the index
+	cmd_index_build(index, s_cmds);
+	test_lookup(index);
+
+	bench_lookup(index);
+
+	return test_result("test_cmdindex");
+}
@@ -0,0 +1,186 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+// equivalence tests and microbenchmarks for the case-insensitive string functions in str.cpp
+// each kernel is checked against the old copy-and-lowercase versions they replaced
+
+#include <cctype>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "str.h"
+#include "test.h"
+
+
+// old versions, from util.cpp before the string kernels were added
+static int old_stristr(std::string haystack, std::string needle) {
+	for (auto& c : haystack)
+		c = (char)std::tolower((unsigned char)c);
+	for (auto& c : needle)
+		c = (char)std::tolower((unsigned char)c);
+
+	return haystack.find(needle) != std::string::npos;
+}
+
+
+static int old_stricmp(std::string s1, std::string s2) {
+	for (auto& c : s1)
+		c = (char)std::tolower((unsigned char)c);
+	for (auto& c : s2)
+		c = (char)std::tolower((unsigned char)c);
+
+	return s1.compare(s2);
+}
+
+
+static int old_striequal(std::string s1, std::string s2) {
+	return old_stricmp(s1, s2) == 0;
+}
+
+
+static int sign(int x) {
+	return (x > 0) - (x < 0);
+}
+
+
+// compare every function on one pair of strings
+static void check_pair(const std::string& a, const std::string& b) {
+	if (str_stristr(a, b) != old_stristr(a, b))
+		test_fail("str_stristr(\"%s\", \"%s\") = %d", a.c_str(), b.c_str(), str_stristr(a, b));
+	if (sign(str_stricmp(a, b)) != sign(old_stricmp(a, b)))
+		test_fail("str_stricmp(\"%s\", \"%s\") = %d", a.c_str(), b.c_str(), str_stricmp(a, b));
+	if (str_striequal(a, b) != old_striequal(a, b))
+		test_fail("str_striequal(\"%s\", \"%s\") = %d", a.c_str(), b.c_str(), str_striequal(a, b));
+}
+
+
+// all strings up to length 3 from characters around the edges of the folded ranges, against each other
+static void test_short_strings() {
+	static const char alphabet[] = "aAzZ@[`{\xc0";
+	std::vector<std::string> strs = { "" };
+	for (size_t start = 0, end = 1, len = 1; len <= 3; len++) {
+		for (size_t i = start; i < end; i++) {
+			for (size_t c = 0; c < sizeof(alphabet) - 1; c++)
+				strs.push_back(strs[i] + alphabet[c]);
+		}
+		start = end;
+		end = strs.size();
+	}
+
+	for (auto& a : strs) {
+		for (auto& b : strs)
+			check_pair(a, b);
+	}
+}
+
+
+// every pair of byte values at every position across the first few 16-byte blocks
+static void test_all_bytes() {
+	for (size_t pos = 0; pos < 40; pos++) {
+		std::string a(pos + 3, 'q');
+		std::string b(pos + 3, 'Q');
+		for (int x = 0; x < 256; x++) {
+			for (int y = 0; y < 256; y++) {
+				a[pos] = (char)x;
+				b[pos] = (char)y;
+				check_pair(a, b);
+				check_pair(a, b.substr(0, pos + 1));
+			}
+		}
+	}
+}
+
+
+// a case-flipped needle at every offset of haystacks up to 3 blocks long, and with its last character changed
+static void test_find_offsets() {
+	std::mt19937 rng(1);
+	for (size_t hlen = 1; hlen <= 48; hlen++) {
+		std::string haystack;
+		for (size_t i = 0; i < hlen; i++)
+			haystack += (char)('a' + rng() % 4);
+
+		for (size_t nlen = 1; nlen <= hlen; nlen++) {
+			for (size_t off = 0; off + nlen <= hlen; off++) {
+				std::string needle = haystack.substr(off, nlen);
+				for (auto& c : needle)
+					c = (char)std::toupper((unsigned char)c);
+				check_pair(haystack, needle);
+				needle.back() = 'E';
+				check_pair(haystack, needle);
+			}
+		}
+	}
+}
+
+
+// random strings, with needles taken from the haystack half the time
+static void test_random() {
+	static const char alphabet[] = "aAbBzZ@[`{ ^7\xc0\xe0\x80\xff" "09";
+	std::mt19937 rng(2);
+	for (int i = 0; i < 200000; i++) {
+		std::string a, b;
+		size_t alen = rng() % 80;
+		for (size_t j = 0; j < alen; j++)
+			a += alphabet[rng() % (sizeof(alphabet) - 1)];
+
+		if (rng() % 2) {
+			b = a.substr(rng() % (alen + 1));
+			b = b.substr(0, rng() % (b.size() + 1));
+			for (auto& c : b) {
+				if (rng() % 2)
+					c = (char)std::toupper((unsigned char)c);
+			}
+		}
+		else {
+			size_t blen = rng() % (i % 3 ? 8 : 80);
+			for (size_t j = 0; j < blen; j++)
+				b += alphabet[rng() % (sizeof(alphabet) - 1)];
+		}
+		check_pair(a, b);
+	}
+}
+
+
+static void bench_kernel() {
+	// typical inputs: player name searches, command names, guids
+	static const std::string names[] = { "^1Some^7Really^3LongPlayerName", "UnnamedPlayer", "^2[ADMIN]^7Kevin", "a much longer name than most players use" };
+	static const std::string cmds[] = { "admin_help", "ADMIN_KICK", "say", "team", "admin_banip", "Admin_Login" };
+	static const std::string guids[] = { "0123456789ABCDEF0123456789ABCDEF", "0123456789abcdef0123456789abcdeg" };
+	const size_t iterations = 2000000;
+
+	bench("str_stristr (player name search)", iterations, [&](size_t i) { return str_stristr(names[i % 4], "longplayer"); });
+	bench("old_stristr", iterations, [&](size_t i) { return old_stristr(names[i % 4], "longplayer"); });
+	bench("str_striequal (command name)", iterations, [&](size_t i) { return str_striequal(cmds[i % 6], "admin_kick"); });
+	bench("old_striequal", iterations, [&](size_t i) { return old_striequal(cmds[i % 6], "admin_kick"); });
+	bench("str_stricmp (32 char guid)", iterations, [&](size_t i) { return str_stricmp(guids[i % 2], guids[0]); });
+	bench("old_stricmp", iterations, [&](size_t i) { return old_stricmp(guids[i % 2], guids[0]); });
+}
+
+
+int main() {
+	static const char* kernels[] = { "scalar", "SSE2" };
+	for (const char* kernel : kernels) {
+		if (!str_use_kernel(kernel)) {
+			printf("%s kernel: not available\n", kernel);
+			continue;
+		}
+		printf("%s kernel:\n", kernel);
+		test_short_strings();
+		test_all_bytes();
+		test_find_offsets();
+		test_random();
+		bench_kernel();
+	}
+
+	return test_result("test_str");
+}
@@ -0,0 +1,225 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+// tests parse_args()'s tokenizer (str_tokenize_args() in str.cpp) against the old parse_args()/parse_str() output
+
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "str.h"
+#include "test.h"
+
+// count heap allocations, to check that tokenizing into reused buffers doesn't allocate
+static size_t s_allocs = 0;
+
+void* operator new(size_t size) {
+	s_allocs++;
+	if (void* p = malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+
+void operator delete(void* p) noexcept {
+	free(p);
+}
+
+
+void operator delete(void* p, size_t) noexcept {
+	free(p);
+}
+
+
+// old versions, from util.cpp before the tokenizer was replaced
+static std::vector<std::string> parse_str(std::string str, char sep) {
+	std::vector<std::string> ret;
+
+	size_t f = str.find(sep);
+	while (f != std::string::npos) {
+		ret.push_back(str.substr(0, f));
+		str = str.substr(f + 1);
+		f = str.find(sep);
+	}
+	if (str.size())
+		ret.push_back(str);
+
+	return ret;
+}
+
+
+// old parse_args(), with the engine's argv passed in
+static std::vector<std::string> old_parse_args(const std::vector<std::string>& argv, int start) {
+	std::string s;
+	for (int i = start; i < (int)argv.size(); i++) {
+		if (i != start)
+			s += " ";
+		s += argv[i];
+	}
+
+	return parse_str(s, ' ');
+}
+
+
+// parse_args() after it has read the engine's argv
+static const std::vector<std::string_view>& new_parse_args(const std::vector<std::string>& argv, int start) {
+	static std::string s_argbuf;
+	static std::vector<std::string_view> s_args;
+
+	str_tokenize_args(argv.data() + start, argv.size() - start, s_argbuf, s_args);
+	return s_args;
+}
+
+
+static std::string describe(const std::vector<std::string>& argv) {
+	std::string ret;
+	for (auto& arg : argv)
+		ret += "[" + arg + "]";
+	return ret;
+}
+
+
+// compare both tokenizers on one command, starting at each argument
+static void check_args(const std::vector<std::string>& argv) {
+	for (int start = 0; start <= (int)argv.size(); start++) {
+		std::vector<std::string> expected = old_parse_args(argv, start);
+		const std::vector<std::string_view>& args = new_parse_args(argv, start);
+
+		if (args.size() != expected.size()) {
+			test_fail("%s from %d: %zu tokens, expected %zu", describe(argv).c_str(), start, args.size(), expected.size());
+			continue;
+		}
+		for (size_t i = 0; i < args.size(); i++) {
+			if (args[i] != expected[i])
+				test_fail("%s from %d: token %zu is \"%.*s\", expected \"%s\"", describe(argv).c_str(), start, i, (int)args[i].size(), args[i].data(), expected[i].c_str());
+			// handlers pass tokens on as C strings
+			else if (args[i].data()[args[i].size()] != '\0')
+				test_fail("%s from %d: token %zu is not null-terminated", describe(argv).c_str(), start, i);
+		}
+	}
+}
+
+
+// commands as the engine delivers them, including say text that arrives as one argument and has to be re-split
+static void test_commands() {
+	static const std::vector<std::vector<std::string>> commands = {
+		{},
+		{ "" },
+		{ "admin_help" },
+		{ "admin_kick", "3" },
+		{ "admin_kick", "Some Player" },
+		{ "admin_ban", "1.2.3.4/24", "30", "spamming the server" },
+		{ "say", "!help" },
+		{ "say", "!kick 3 stop spamming" },
+		{ "say", "!kick  3   two  spaces" },
+		{ "say", " !leading space" },
+		{ "say", "trailing space " },
+		{ "say", "trailing spaces   " },
+		{ "say", "   " },
+		{ "say", "" },
+		{ "say", "!login", "secret" },
+		{ "say", "!vote", "map", "q3dm17" },
+		{ "say", "tabs\tare\tnot\tseparators" },
+		{ "say", "\"quoted text\" ; semicolons" },
+		{ "say", "^1colored ^7text" },
+		{ "say_team", "!kick 3" },
+		{ "sv", "admin_help", "kick" },
+		{ "admin_adduser_name", "Admin", "pass", "65535" },
+		{ "", "", "" },
+		{ "a", "", "b" },
+		{ " ", " " },
+		{ std::string(1000, 'x'), std::string(1000, ' ') + "y" },
+	};
+
+	for (auto& argv : commands)
+		check_args(argv);
+}
+
+
+// random commands made of words, spaces and empty args
+static void test_random() {
+	static const char* pieces[] = { "", " ", "  ", "a", "bc", "!kick", "say", "\t", "x y", " z " };
+	std::mt19937 rng(1);
+	for (int i = 0; i < 100000; i++) {
+		std::vector<std::string> argv(rng() % 6);
+		for (auto& arg : argv) {
+			size_t count = rng() % 5;
+			for (size_t j = 0; j < count; j++)
+				arg += pieces[rng() % (sizeof(pieces) / sizeof(pieces[0]))];
+		}
+		check_args(argv);
+	}
+}
+
+
+// quoted words for admin_vote_custom
+static void test_quoted() {
+	static const std::vector<std::pair<std::string, std::vector<std::string>>> cases = {
+		{ "", {} },
+		{ "   ", {} },
+		{ "yes no", { "yes", "no" } },
+		{ "  yes   no  ", { "yes", "no" } },
+		{ "\"Change map?\" \"yes please\" no", { "Change map?", "yes please", "no" } },
+		{ "\"\" a", { "", "a" } },
+		{ "a\"b c\"d e", { "ab cd", "e" } },
+		{ "\"unclosed quote", { "unclosed quote" } },
+		{ "end\"", { "end" } },
+	};
+
+	for (auto& c : cases) {
+		std::vector<std::string> words = str_split_quoted(c.first);
+		if (words != c.second)
+			test_fail("str_split_quoted(\"%s\"): %zu words, expected %zu", c.first.c_str(), words.size(), c.second.size());
+	}
+}
+
+
+// once the buffers have grown, tokenizing a chat line shouldn't allocate
+static void test_no_allocs() {
+	std::vector<std::string> argv = { "say", "!kick 3 stop spamming the server please" };
+	new_parse_args(argv, 0);
+
+	size_t before = s_allocs;
+	for (int i = 0; i < 1000; i++)
+		new_parse_args(argv, 0);
+	TEST_CHECK(s_allocs == before);
+}
+
+
+static void bench_tokenize() {
+	std::vector<std::string> chat = { "say", "!kick 3 stop spamming the server please" };
+	std::vector<std::string> cmd = { "admin_ban", "1.2.3.4/24", "30", "spamming" };
+	const size_t iterations = 1000000;
+
+	printf("tokenizer:\n");
+	bench("parse_args (chat line)", iterations, [&](size_t) { return new_parse_args(chat, 0).size(); });
+	bench("old parse_args", iterations, [&](size_t) { return old_parse_args(chat, 0).size(); });
+	bench("parse_args (console command)", iterations, [&](size_t) { return new_parse_args(cmd, 0).size(); });
+	bench("old parse_args", iterations, [&](size_t) { return old_parse_args(cmd, 0).size(); });
+
+	size_t before = s_allocs;
+	old_parse_args(chat, 0);
+	printf("  old parse_args allocations per chat line: %zu\n", s_allocs - before);
+}
+
+
+int main() {
+	test_commands();
+	test_random();
+	test_quoted();
+	test_no_allocs();
+	bench_tokenize();
+
+	return test_result("test_tokenize");
+}
@@ -0,0 +1,234 @@
+/*
+QADMIN_QMM - Server Administration Plugin
+Copyright 2004-2026
+https://github.com/thecybermind/qadmin_qmm/
+3-clause BSD license: https://opensource.org/license/bsd-3-clause
+
+Created By:
+    Kevin Masterson < k.m.masterson@gmail.com >
+
+*/
+
+// tests and benchmarks the indexed user store and database format against the old flat user list
+
+#include <cctype>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "main.h"
+#include "str.h"
+#include "users.h"
+#include "test.h"
+
+
+// user entry number i, cycling through the types like a shared admin list
+static user_info make_user(size_t i) {
+	char user[64];
+	char pass[32];
+	addusertype type = (addusertype)(au_ip + i % 3);
+	if (type == au_ip)
+		str_printf(user, sizeof(user), "10.%d.%d.%d", (int)(i >> 16) & 255, (int)(i >> 8) & 255, (int)i & 255);
+	else if (type == au_name)
+		str_printf(user, sizeof(user), "^%dPlayer%zu", (int)(i % 10), i);
+	else
+		str_printf(user, sizeof(user), "%08zX%024zX", i * 2654435761u, i);
+	str_printf(pass, sizeof(pass), "pass%zu", i);
+	return { user, pass, (int)(i % 65536), type, 0 };
+}
+
+
+// the login keys a player with entry i would present, in a different case
+static std::string login_key(const user_info& info) {
+	std::string key = info.user;
+	for (auto& c : key)
+		c = (char)(std::isupper((unsigned char)c) ? std::tolower((unsigned char)c) : std::toupper((unsigned char)c));
+	return key;
+}
+
+
+// old versions, from cmds.cpp before the user store was added
+static int old_striequal(std::string s1, std::string s2) {
+	for (auto& c : s1)
+		c = (char)std::tolower((unsigned char)c);
+	for (auto& c : s2)
+		c = (char)std::tolower((unsigned char)c);
+
+	return s1.compare(s2) == 0;
+}
+
+
+// admin_adduser() duplicate check and insert
+static bool old_add(std::vector<user_info>& users, const user_info& newuser) {
+	for (auto& info : users) {
+		if (info.type == newuser.type && old_striequal(newuser.user, info.user))
+			return false;
+	}
+	users.push_back(newuser);
+	return true;
+}
+
+
+// admin_login() search, with the player's name, ip and guid
+static const user_info* old_login(const std::vector<user_info>& users, const std::string& name, const std::string& ip, const std::string& guid, const std::string& password) {
+	for (auto& info : users) {
+		std::string match = name;
+		if (info.type == au_ip)
+			match = ip;
+		else if (info.type == au_id)
+			match = guid;
+
+		if (old_striequal(info.user, match) && old_striequal(info.pass, password))
+			return &info;
+	}
+	return nullptr;
+}
+
+
+static void check_find(const user_store& store, const user_info& info, size_t order) {
+	user_match match;
+	if (!store.find(info.type, login_key(info), match))
+		test_fail("user %d \"%s\" not found", (int)info.type, info.user.c_str());
+	else if (match.pass != info.pass || match.access != info.access || match.order != order)
+		test_fail("user %d \"%s\" found with pass \"%.*s\", access %d, order %zu", (int)info.type, info.user.c_str(), (int)match.pass.size(), match.pass.data(), match.access, match.order);
+}
+
+
+static void test_store() {
+	const size_t num = 3000;
+	user_store store;
+	for (size_t i = 0; i < num; i++)
+		TEST_CHECK(store.add(make_user(i)));
+	TEST_CHECK(store.size() == num);
+
+	// duplicates in another case or spelling are rejected
+	for (size_t i = 0; i < num; i++) {
+		user_info dup = make_user(i);
+		dup.user = login_key(dup);
+		if (store.add(dup))
+			test_fail("duplicate user %d \"%s\" added", (int)dup.type, dup.user.c_str());
+	}
+	TEST_CHECK(!store.add({ "::ffff:10.0.0.0", "x", 1, au_ip, 0 }));
+	TEST_CHECK(store.size() == num);
+
+	for (size_t i = 0; i < num; i++)
+		check_find(store, make_user(i), i);
+
+	user_match match;
+	TEST_CHECK(!store.find(au_name, "nobody", match));
+	TEST_CHECK(!store.find(au_id, "", match));
+	TEST_CHECK(!store.find(au_ip, "10.255.255.255", match));
+	// the same user under another type
+	TEST_CHECK(!store.find(au_id, make_user(1).user, match));
+
+	// write it out and load it back as a database
+	std::vector<char> data;
+	TEST_CHECK(store.serialize(data) == 0);
+	user_store loaded;
+	loaded.db.buf = data;
+	TEST_CHECK(loaded.db.parse() == nullptr);
+	TEST_CHECK(loaded.size() == num);
+	for (size_t i = 0; i < num; i++)
+		check_find(loaded, make_user(i), i);
+
+	size_t entries = 0;
+	loaded.for_each([&](addusertype, std::string_view, const user_match&) { entries++; });
+	TEST_CHECK(entries == num);
+
+	// a config entry replaces its database record and keeps its place
+	user_info replaced = make_user(7);
+	replaced.pass = "newpass";
+	replaced.access = 12345;
+	TEST_CHECK(loaded.add(replaced));
+	TEST_CHECK(loaded.size() == num);
+	check_find(loaded, replaced, 7);
+	// and a new one comes after all of them
+	user_info added = make_user(num);
+	TEST_CHECK(loaded.add(added));
+	TEST_CHECK(loaded.size() == num + 1);
+	TEST_CHECK(loaded.find(added.type, added.user, match) && match.access == added.access && match.order >= num);
+
+	entries = 0;
+	loaded.for_each([&](addusertype, std::string_view, const user_match&) { entries++; });
+	TEST_CHECK(entries == num + 1);
+
+	// damaged files are rejected
+	user_db db;
+	db.buf = data;
+	db.buf[data.size() / 2] ^= 1;
+	TEST_CHECK(db.parse() != nullptr);
+	db.buf.assign(data.begin(), data.end() - 1);
+	TEST_CHECK(db.parse() != nullptr);
+	db.buf.assign(data.begin(), data.begin() + 8);
+	TEST_CHECK(db.parse() != nullptr);
+	TEST_CHECK(db.count == 0);
+}
+
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+static void bench_load(size_t num, bool old) {
+	std::vector<user_info> users;
+	for (size_t i = 0; i < num; i++)
+		users.push_back(make_user(i));
+
+	auto start = std::chrono::steady_clock::now();
+	user_store store;
+	for (auto& info : users)
+		store.add(info);
+	printf("  %zu users: config load %.1f ms", num, elapsed_ms(start));
+
+	std::vector<char> data;
+	store.serialize(data);
+	start = std::chrono::steady_clock::now();
+	user_store loaded;
+	loaded.db.buf = data;
+	loaded.db.parse();
+	printf(", database load %.1f ms", elapsed_ms(start));
+
+	std::vector<user_info> oldusers;
+	if (old) {
+		start = std::chrono::steady_clock::now();
+		for (auto& info : users)
+			old_add(oldusers, info);
+		printf(", old config load %.1f ms", elapsed_ms(start));
+	}
+	printf("\n");
+
+	// a login checks the player's name, ip and guid
+	std::vector<std::string> keys;
+	for (auto& info : users)
+		keys.push_back(login_key(info));
+	auto login = [&](const user_store& s, size_t i) {
+		user_match match;
+		size_t found = 0;
+		found += s.find(au_name, keys[i % num], match);
+		found += s.find(au_ip, keys[(i + 1) % num], match);
+		found += s.find(au_id, keys[(i + 2) % num], match);
+		return found;
+	};
+	bench("login, config entries", 300000, [&](size_t i) { return login(store, i * 7919); });
+	bench("login, database records", 300000, [&](size_t i) { return login(loaded, i * 7919); });
+	if (old) {
+		bench("old login", 200, [&](size_t i) {
+			size_t n = i * 7919 % (num - 2);
+			return old_login(oldusers, keys[n], keys[n + 1], keys[n + 2], "wrong") != nullptr;
+		});
+	}
+}
+
+
+int main() {
+	test_store();
+
+	printf("user store:\n");
+	bench_load(1000, true);
+	bench_load(4000, true);
+	bench_load(10000, false);
+	bench_load(100000, false);
+
+	return test_result("test_userstore");
+}